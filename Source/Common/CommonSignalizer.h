@@ -35,6 +35,11 @@
 	#include <cpl/gui/GUI.h>
 	#include <cpl/CAudioStream.h>
 	#include <complex>
+	#include <algorithm>
+	#include <array>
+	#include <cstdint>
+	#include <limits>
+	#include <vector>
 	#include <cpl/infrastructure/parameters/ParameterSystem.h>
 	#include "SignalizerDesign.h"
 
@@ -84,6 +89,12 @@
 			virtual std::unique_ptr<StateEditor> createEditor() = 0;
 			virtual ParameterSet & getParameterSet() = 0;
 
+			/// <summary>
+			/// Data measured during the session, as opposed to settings. Only stored with the host state, never in presets.
+			/// </summary>
+			virtual void serializeMeasurements(cpl::CSerializer::Archiver & ar, cpl::Version v) {}
+			virtual void deserializeMeasurements(cpl::CSerializer::Builder & ar, cpl::Version v) {}
+
 			virtual ~ProcessorState() {}
 
 		};
@@ -386,9 +397,277 @@
 			/// Channels 1 and 2 are interpreted as a complex sequence of real and imaginary numbers
 			/// </summary>
 			Complex,
+			/// <summary>
+			/// Channel 1 is a reference, channel 2 a measurement. The averaged transfer function magnitude
+			/// is displayed together with the magnitude-squared coherence.
+			/// </summary>
+			Transfer,
 			End
 		};
 
+		/// <summary>
+		/// Incrementally maintained min/max pyramid of an audio stream, so zoomed out displays can draw
+		/// envelopes with a bounded amount of vertices instead of aliasing individual samples, and the
+		/// peak of a window can be found without scanning it.
+		/// Level n reduces getFactor(n) samples into one pair of extremes; buckets are aligned to the
+		/// total amount of samples added, so their position relative to the audio head is known.
+		/// </summary>
+		class EnvelopePyramid
+		{
+		public:
+
+			static const std::size_t BaseShift = 2;
+			static const std::size_t Levels = 15;
+
+			struct Extremes
+			{
+				AFloat low, high;
+
+				/// <summary>
+				/// The largest magnitude, or zero if empty.
+				/// </summary>
+				AFloat peak() const noexcept
+				{
+					return std::max({ AFloat(0), -low, high });
+				}
+			};
+
+			static std::size_t getFactor(std::size_t level) noexcept
+			{
+				return std::size_t(1) << (level + BaseShift);
+			}
+
+			/// <summary>
+			/// Returns the coarsest level that still has at least one bucket per pixel.
+			/// </summary>
+			static std::size_t getLevelFor(double samplesPerPixel) noexcept
+			{
+				std::size_t level = 0;
+
+				while (level + 1 < Levels && getFactor(level + 1) <= samplesPerPixel)
+					level++;
+
+				return level;
+			}
+
+			/// <summary>
+			/// Sizes the history to cover at least the given amount of samples. Only clears the history
+			/// if the size actually changed.
+			/// </summary>
+			void resize(std::size_t samples)
+			{
+				if (samples == capacity)
+					return;
+
+				capacity = samples;
+				written = 0;
+
+				for (std::size_t i = 0; i < Levels; ++i)
+				{
+					levels[i].ring.assign(samples / getFactor(i) + 2, Extremes{});
+					levels[i].cursor = levels[i].count = 0;
+				}
+			}
+
+			/// <summary>
+			/// Forgets all added samples, without changing the size.
+			/// </summary>
+			void clear() noexcept
+			{
+				written = 0;
+
+				for (auto & l : levels)
+					l.cursor = l.count = 0;
+			}
+
+			inline void add(AFloat sample) noexcept
+			{
+				auto & base = levels[0];
+
+				if (base.count == 0)
+				{
+					base.pending = { sample, sample };
+				}
+				else
+				{
+					base.pending.low = std::min(base.pending.low, sample);
+					base.pending.high = std::max(base.pending.high, sample);
+				}
+
+				written++;
+
+				if (++base.count == getFactor(0))
+					commit(0);
+			}
+
+			/// <summary>
+			/// The amount of samples added after the newest complete bucket of the level.
+			/// </summary>
+			std::size_t getPending(std::size_t level) const noexcept
+			{
+				return static_cast<std::size_t>(written & (getFactor(level) - 1));
+			}
+
+			/// <summary>
+			/// The amount of complete buckets that can be read from the level.
+			/// </summary>
+			std::size_t getAvailable(std::size_t level) const noexcept
+			{
+				return static_cast<std::size_t>(std::min<std::uint64_t>(levels[level].ring.size(), written >> (level + BaseShift)));
+			}
+
+			/// <summary>
+			/// The total amount of samples added since the history was last cleared.
+			/// </summary>
+			std::uint64_t getWritten() const noexcept
+			{
+				return written;
+			}
+
+			/// <summary>
+			/// Returns the bucket that completed bucketsAgo buckets before the newest one.
+			/// bucketsAgo must be less than getAvailable(level).
+			/// </summary>
+			const Extremes & get(std::size_t level, std::size_t bucketsAgo) const noexcept
+			{
+				auto & l = levels[level];
+				auto index = l.cursor + l.ring.size() - 1 - bucketsAgo;
+				if (index >= l.ring.size())
+					index -= l.ring.size();
+
+				return l.ring[index];
+			}
+
+			/// <summary>
+			/// Returns the extremes of the newest amount of samples, reduced from at most two buckets per level so the cost
+			/// barely depends on the amount. The oldest samples of the range that don't fill a base bucket are unknown to the
+			/// pyramid; their amount (less than getFactor(0)) is returned in uncovered, for the caller to reduce from the audio.
+			/// The amount shouldn't exceed the size of the history, and the extremes are empty if no bucket is inside the range.
+			/// </summary>
+			Extremes getExtremes(std::size_t samples, std::size_t & uncovered) const noexcept
+			{
+				Extremes result{ std::numeric_limits<AFloat>::max(), std::numeric_limits<AFloat>::lowest() };
+
+				auto include = [&result](const Extremes & e)
+				{
+					result.low = std::min(result.low, e.low);
+					result.high = std::max(result.high, e.high);
+				};
+
+				auto const end = written;
+				auto const begin = end - std::min<std::uint64_t>(samples, end);
+				auto const pending = levels[0].count;
+
+				// the base bucket being filled holds the newest samples
+				if (end - begin < pending)
+				{
+					uncovered = static_cast<std::size_t>(end - begin);
+					return result;
+				}
+
+				if (pending)
+					include(levels[0].pending);
+
+				auto const base = static_cast<std::uint64_t>(getFactor(0));
+				auto const first = (begin + base - 1) & ~(base - 1);
+				auto position = end - pending;
+
+				// walk back from the newest complete bucket, every step taking the largest bucket
+				// that ends at the position and doesn't start before the range
+				while (position > first)
+				{
+					std::size_t level = 0;
+
+					while (level + 1 < Levels && (position & (getFactor(level + 1) - 1)) == 0 && position - getFactor(level + 1) >= first)
+						level++;
+
+					auto const shift = level + BaseShift;
+					include(get(level, static_cast<std::size_t>((end >> shift) - (position >> shift))));
+					position -= getFactor(level);
+				}
+
+				uncovered = static_cast<std::size_t>(first - begin);
+				return result;
+			}
+
+			/// <summary>
+			/// Makes this a copy of the newest buckets of other, covering at least the given amount of samples.
+			/// Only the buckets reachable from that range are copied.
+			/// </summary>
+			void copyNewest(const EnvelopePyramid & other, std::size_t samples)
+			{
+				capacity = samples;
+				written = other.written;
+
+				for (std::size_t i = 0; i < Levels; ++i)
+				{
+					auto & l = levels[i];
+					auto const & o = other.levels[i];
+
+					l.ring.resize(samples / getFactor(i) + 2);
+					l.count = o.count;
+					l.pending = o.pending;
+
+					auto const amount = std::min(l.ring.size(), other.getAvailable(i));
+
+					// oldest first, so the cursor ends up right after the newest bucket
+					for (std::size_t n = 0; n < amount; ++n)
+						l.ring[n] = other.get(i, amount - 1 - n);
+
+					l.cursor = amount == l.ring.size() ? 0 : amount;
+				}
+			}
+
+		private:
+
+			void commit(std::size_t level) noexcept
+			{
+				for (; level < Levels; ++level)
+				{
+					auto & current = levels[level];
+					auto const value = current.pending;
+					current.count = 0;
+
+					if (current.ring.empty())
+						return;
+
+					current.ring[current.cursor] = value;
+					if (++current.cursor == current.ring.size())
+						current.cursor = 0;
+
+					if (level + 1 == Levels)
+						break;
+
+					// every parent reduces two buckets of its child
+					auto & parent = levels[level + 1];
+
+					if (parent.count == 0)
+					{
+						parent.pending = value;
+					}
+					else
+					{
+						parent.pending.low = std::min(parent.pending.low, value.low);
+						parent.pending.high = std::max(parent.pending.high, value.high);
+					}
+
+					if (++parent.count != 2)
+						break;
+				}
+			}
+
+			struct Level
+			{
+				std::vector<Extremes> ring;
+				std::size_t cursor = 0, count = 0;
+				Extremes pending{};
+			};
+
+			std::array<Level, Levels> levels;
+			std::uint64_t written = 0;
+			std::size_t capacity = 0;
+		};
+
 		template<typename Scalar>
 		union UComplexFilter
 		{
@@ -0,0 +1,225 @@
+/*************************************************************************************
+ 
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+ 
+	Copyright (C) 2016 Janus Lynggaard Thorborg (www.jthorborg.com)
+ 
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+ 
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+ 
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ 
+	See \licenses\ for additional details on licenses associated with this program.
+ 
+**************************************************************************************
+ 
+	file:LineGeometry.h
+
+		Line strips for LineStream, and the transforms they are drawn with.
+ 
+*************************************************************************************/
+
+#ifndef SIGNALIZER_LINEGEOMETRY_H
+	#define SIGNALIZER_LINEGEOMETRY_H
+
+	#include <algorithm>
+	#include <cmath>
+	#include <cstddef>
+	#include <cstdint>
+	#include <vector>
+
+	namespace Signalizer
+	{
+		/// <summary>
+		/// A point of a line strip. Consecutive points are read as the two ends of a segment by the line shader,
+		/// which draws every segment as an instanced quad widened in screen space.
+		/// </summary>
+		struct LinePoint
+		{
+			float x, y, z;
+			std::uint8_t r, g, b, a;
+		};
+
+		/// <summary>
+		/// A column major 4x4 matrix, composed like the fixed function matrix operations: every operation applies
+		/// to vertices before the ones already in the transform.
+		/// </summary>
+		struct LineTransform
+		{
+			float m[16];
+
+			static LineTransform identity() noexcept
+			{
+				return { { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 } };
+			}
+
+			static LineTransform fromColumnMajor(const float * matrix) noexcept
+			{
+				LineTransform ret;
+				std::copy(matrix, matrix + 16, ret.m);
+				return ret;
+			}
+
+			/// <summary>
+			/// this = this * right
+			/// </summary>
+			LineTransform & multiply(const LineTransform & right) noexcept
+			{
+				LineTransform product;
+
+				for (int column = 0; column < 4; ++column)
+				{
+					for (int row = 0; row < 4; ++row)
+					{
+						float sum = 0;
+
+						for (int k = 0; k < 4; ++k)
+							sum += m[k * 4 + row] * right.m[column * 4 + k];
+
+						product.m[column * 4 + row] = sum;
+					}
+				}
+
+				return *this = product;
+			}
+
+			LineTransform & translate(float x, float y, float z) noexcept
+			{
+				auto t = identity();
+				t.m[12] = x; t.m[13] = y; t.m[14] = z;
+				return multiply(t);
+			}
+
+			LineTransform & scale(float x, float y, float z) noexcept
+			{
+				auto s = identity();
+				s.m[0] = x; s.m[5] = y; s.m[10] = z;
+				return multiply(s);
+			}
+
+			/// <summary>
+			/// Counter clockwise rotation around the z axis.
+			/// </summary>
+			LineTransform & rotateZ(float degrees) noexcept
+			{
+				auto const radians = degrees * 3.14159265358979f / 180;
+				auto const c = std::cos(radians), s = std::sin(radians);
+				auto r = identity();
+				r.m[0] = c; r.m[1] = s; r.m[4] = -s; r.m[5] = c;
+				return multiply(r);
+			}
+		};
+
+		/// <summary>
+		/// Line strips stored as points, to be drawn by a LineStream. Segments share their points with their neighbours,
+		/// so a strip costs as much memory as it would as a GL_LINE_STRIP.
+		/// Has no dependencies on OpenGL, so the geometry can be generated without a context.
+		/// </summary>
+		class LineGeometry
+		{
+		public:
+
+			struct Point
+			{
+				float x, y, z;
+			};
+
+			struct Colour
+			{
+				std::uint8_t r, g, b, a;
+			};
+
+			/// <summary>
+			/// The points of one strip in data()
+			/// </summary>
+			struct Strip
+			{
+				std::size_t first, count;
+			};
+
+			/// <summary>
+			/// Forgets the strips, but keeps the memory for the next ones.
+			/// </summary>
+			void clear() noexcept
+			{
+				count = 0;
+				strips.clear();
+			}
+
+			/// <summary>
+			/// Makes room for adding the amount of points without reallocating.
+			/// </summary>
+			void reserve(std::size_t points)
+			{
+				auto const required = count + points;
+
+				if (required > this->points.size())
+					this->points.resize(std::max(required, 2 * this->points.size()));
+			}
+
+			/// <summary>
+			/// Adds connected segments through the points, like GL_LINE_STRIP.
+			/// pointAt(i) returns the x, y and z of every i in [0, points), and colourAt(i) the Colour.
+			/// </summary>
+			template<typename PointAt, typename ColourAt>
+				void addStrip(std::size_t points, PointAt && pointAt, ColourAt && colourAt)
+				{
+					if (points < 2)
+						return;
+
+					reserve(points);
+
+					auto * const output = this->points.data() + count;
+
+					for (std::size_t i = 0; i < points; ++i)
+					{
+						const auto position = pointAt(i);
+						const Colour colour = colourAt(i);
+
+						output[i] = { position.x, position.y, position.z, colour.r, colour.g, colour.b, colour.a };
+					}
+
+					strips.push_back({ count, points });
+					count += points;
+				}
+
+			const LinePoint * data() const noexcept
+			{
+				return points.data();
+			}
+
+			/// <summary>
+			/// The amount of points
+			/// </summary>
+			std::size_t size() const noexcept
+			{
+				return count;
+			}
+
+			const std::vector<Strip> & getStrips() const noexcept
+			{
+				return strips;
+			}
+
+			bool empty() const noexcept
+			{
+				return strips.empty();
+			}
+
+		private:
+
+			std::vector<LinePoint> points;
+			std::vector<Strip> strips;
+			std::size_t count = 0;
+		};
+	};
+
+#endif
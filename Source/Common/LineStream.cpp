@@ -0,0 +1,242 @@
+/*************************************************************************************
+ 
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+ 
+	Copyright (C) 2016 Janus Lynggaard Thorborg (www.jthorborg.com)
+ 
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+ 
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+ 
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ 
+	See \licenses\ for additional details on licenses associated with this program.
+ 
+**************************************************************************************
+ 
+	file:LineStream.cpp
+
+		Implementation of LineStream.h
+ 
+*************************************************************************************/
+
+#include "LineStream.h"
+#include <cstddef>
+
+namespace Signalizer
+{
+	using namespace juce::gl;
+
+	static const char * const LineVertexShader = R"(
+		attribute vec2 corner;
+		attribute vec3 start;
+		attribute vec3 end;
+		attribute vec4 startColour;
+		attribute vec4 endColour;
+
+		uniform mat4 transform;
+		uniform vec2 halfViewport;
+		uniform float halfWidth;
+		uniform float feather;
+
+		varying vec4 fragmentColour;
+		varying float edgeDistance;
+
+		void main()
+		{
+			vec4 first = transform * vec4(start, 1.0);
+			vec4 second = transform * vec4(end, 1.0);
+
+			// the direction of the segment in pixels
+			vec2 direction = (second.xy / second.w - first.xy / first.w) * halfViewport;
+			float pixels = length(direction);
+			vec2 normal = pixels > 0.0 ? vec2(-direction.y, direction.x) / pixels : vec2(0.0, 1.0);
+
+			// pushed out by half the width and the feather, so the faded edge is covered as well
+			float extent = halfWidth + feather;
+			vec4 position = mix(first, second, corner.x);
+			position.xy += normal * corner.y * extent / halfViewport * position.w;
+
+			edgeDistance = corner.y * extent;
+			fragmentColour = mix(startColour, endColour, corner.x);
+			gl_Position = position;
+		}
+	)";
+
+	static const char * const LineFragmentShader = R"(
+		uniform float halfWidth;
+		uniform float feather;
+
+		varying vec4 fragmentColour;
+		varying float edgeDistance;
+
+		void main()
+		{
+			float coverage = clamp((halfWidth + feather - abs(edgeDistance)) / feather, 0.0, 1.0);
+			gl_FragColor = fragmentColour * coverage;
+		}
+	)";
+
+	/// <summary>
+	/// (along the segment, side of the segment) of the quad drawn for every segment, as a triangle strip
+	/// </summary>
+	static const GLfloat LineCorners[] = { 0, -1, 0, 1, 1, -1, 1, 1 };
+
+	LineStream::~LineStream()
+	{
+		release();
+	}
+
+	bool LineStream::create()
+	{
+		release();
+
+		auto * context = juce::OpenGLContext::getCurrentContext();
+
+		// every segment is an instance reading two consecutive points
+		if (!context || glVertexAttribDivisor == nullptr || glDrawArraysInstanced == nullptr)
+			return false;
+
+		auto shader = std::make_unique<juce::OpenGLShaderProgram>(*context);
+
+		if (!shader->addVertexShader(juce::OpenGLHelpers::translateVertexShaderToV3(LineVertexShader))
+			|| !shader->addFragmentShader(juce::OpenGLHelpers::translateFragmentShaderToV3(LineFragmentShader)))
+		{
+			return false;
+		}
+
+		auto const id = shader->getProgramID();
+
+		// some compatibility profiles only draw if attribute zero isn't instanced
+		glBindAttribLocation(id, 0, "corner");
+
+		if (!shader->link())
+			return false;
+
+		corner = glGetAttribLocation(id, "corner");
+		start = glGetAttribLocation(id, "start");
+		end = glGetAttribLocation(id, "end");
+		startColour = glGetAttribLocation(id, "startColour");
+		endColour = glGetAttribLocation(id, "endColour");
+
+		if (corner < 0 || start < 0 || end < 0 || startColour < 0 || endColour < 0)
+			return false;
+
+		transform = std::make_unique<juce::OpenGLShaderProgram::Uniform>(*shader, "transform");
+		halfViewport = std::make_unique<juce::OpenGLShaderProgram::Uniform>(*shader, "halfViewport");
+		halfWidth = std::make_unique<juce::OpenGLShaderProgram::Uniform>(*shader, "halfWidth");
+		feather = std::make_unique<juce::OpenGLShaderProgram::Uniform>(*shader, "feather");
+
+		glGenBuffers(1, &corners);
+		glBindBuffer(GL_ARRAY_BUFFER, corners);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(LineCorners), LineCorners, GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		glGenBuffers(1, &buffer);
+
+		// core profiles can't draw without a vertex array object
+		if (glGenVertexArrays != nullptr)
+			glGenVertexArrays(1, &vertexArray);
+
+		program = std::move(shader);
+		return true;
+	}
+
+	void LineStream::release()
+	{
+		if (buffer)
+			glDeleteBuffers(1, &buffer);
+
+		if (corners)
+			glDeleteBuffers(1, &corners);
+
+		if (vertexArray)
+			glDeleteVertexArrays(1, &vertexArray);
+
+		buffer = corners = vertexArray = 0;
+		capacity = 0;
+
+		transform = halfViewport = halfWidth = feather = nullptr;
+		program = nullptr;
+	}
+
+	void LineStream::draw(const LineGeometry & geometry, const LineTransform & view, float width, bool antialias)
+	{
+		if (!program || geometry.empty())
+			return;
+
+		GLint viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+
+		program->use();
+		transform->setMatrix4(view.m, 1, GL_FALSE);
+		halfViewport->set(viewport[2] * 0.5f, viewport[3] * 0.5f);
+		halfWidth->set(std::max(width, 1.0f) * 0.5f);
+		// without antialiasing, the edge is hard but still placed with subpixel precision
+		feather->set(antialias ? 1.0f : 0.001f);
+
+		if (vertexArray)
+			glBindVertexArray(vertexArray);
+
+		glBindBuffer(GL_ARRAY_BUFFER, corners);
+		glEnableVertexAttribArray(static_cast<GLuint>(corner));
+		glVertexAttribPointer(static_cast<GLuint>(corner), 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+		auto const bytes = geometry.size() * sizeof(LinePoint);
+
+		if (bytes > capacity)
+			capacity = std::max(bytes, 2 * capacity);
+
+		// orphan the storage used by the previous draw, so the driver doesn't have to wait for it to finish
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(bytes), geometry.data());
+
+		for (auto location : { start, end, startColour, endColour })
+		{
+			glEnableVertexAttribArray(static_cast<GLuint>(location));
+			glVertexAttribDivisor(static_cast<GLuint>(location), 1);
+		}
+
+		auto attribute = [](GLint location, GLint components, GLenum type, GLboolean normalized, std::size_t offset)
+		{
+			glVertexAttribPointer(static_cast<GLuint>(location), components, type, normalized, sizeof(LinePoint), reinterpret_cast<const void *>(offset));
+		};
+
+		for (auto & strip : geometry.getStrips())
+		{
+			// segment n of the strip reads point n as its start and point n + 1 as its end
+			auto const first = strip.first * sizeof(LinePoint), second = first + sizeof(LinePoint);
+
+			attribute(start, 3, GL_FLOAT, GL_FALSE, first + offsetof(LinePoint, x));
+			attribute(startColour, 4, GL_UNSIGNED_BYTE, GL_TRUE, first + offsetof(LinePoint, r));
+			attribute(end, 3, GL_FLOAT, GL_FALSE, second + offsetof(LinePoint, x));
+			attribute(endColour, 4, GL_UNSIGNED_BYTE, GL_TRUE, second + offsetof(LinePoint, r));
+
+			glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(strip.count - 1));
+		}
+
+		// other code draws with these attributes as well, and doesn't expect them to be instanced
+		for (auto location : { start, end, startColour, endColour })
+		{
+			glVertexAttribDivisor(static_cast<GLuint>(location), 0);
+			glDisableVertexAttribArray(static_cast<GLuint>(location));
+		}
+
+		glDisableVertexAttribArray(static_cast<GLuint>(corner));
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		if (vertexArray)
+			glBindVertexArray(0);
+
+		glUseProgram(0);
+	}
+};
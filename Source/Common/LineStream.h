@@ -0,0 +1,82 @@
+/*************************************************************************************
+ 
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+ 
+	Copyright (C) 2016 Janus Lynggaard Thorborg (www.jthorborg.com)
+ 
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+ 
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+ 
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ 
+	See \licenses\ for additional details on licenses associated with this program.
+ 
+**************************************************************************************
+ 
+	file:LineStream.h
+
+		Streams line strips to OpenGL through a vertex buffer and draws them with a line shader.
+ 
+*************************************************************************************/
+
+#ifndef SIGNALIZER_LINESTREAM_H
+	#define SIGNALIZER_LINESTREAM_H
+
+	#include <cpl/rendering/OpenGLRasterizers.h>
+	#include <memory>
+	#include "LineGeometry.h"
+
+	namespace Signalizer
+	{
+		/// <summary>
+		/// Uploads the points of LineGeometry into an orphaned vertex buffer every draw, and draws every segment as an
+		/// instanced quad that a shader widens in screen space and antialiases the edges of. Requires instancing
+		/// (OpenGL 3.3, or the ARB extensions), and only reads state core profiles provide.
+		/// Must only be used while the OpenGL context it was created in is active.
+		/// </summary>
+		class LineStream
+		{
+		public:
+
+			~LineStream();
+
+			/// <summary>
+			/// Compiles the shader and creates the buffers in the current context.
+			/// Returns false, and stays unusable, if that fails or instancing isn't supported.
+			/// </summary>
+			bool create();
+			/// <summary>
+			/// Frees the OpenGL resources. Safe to call if not created.
+			/// </summary>
+			void release();
+
+			bool isCreated() const noexcept
+			{
+				return program != nullptr;
+			}
+
+			/// <summary>
+			/// Draws the geometry through the view transform into the current viewport, with the current blending.
+			/// The width is in pixels; if antialias is set, the edges fade out over a pixel.
+			/// </summary>
+			void draw(const LineGeometry & geometry, const LineTransform & view, float width, bool antialias);
+
+		private:
+
+			std::unique_ptr<juce::OpenGLShaderProgram> program;
+			std::unique_ptr<juce::OpenGLShaderProgram::Uniform> transform, halfViewport, halfWidth, feather;
+			GLint corner = -1, start = -1, end = -1, startColour = -1, endColour = -1;
+			GLuint buffer = 0, corners = 0, vertexArray = 0;
+			std::size_t capacity = 0;
+		};
+	};
+
+#endif
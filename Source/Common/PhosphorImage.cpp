@@ -0,0 +1,162 @@
+/*************************************************************************************
+
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+
+	Copyright (C) 2016 Janus Lynggaard Thorborg (www.jthorborg.com)
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	See \licenses\ for additional details on licenses associated with this program.
+
+**************************************************************************************
+
+	file:PhosphorImage.cpp
+
+		Implementation of PhosphorImage.h
+
+*************************************************************************************/
+
+#include "PhosphorImage.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Signalizer
+{
+	using namespace juce::gl;
+
+	constexpr AFloat PhosphorImage::VisibleLevel;
+
+	bool PhosphorImage::resize(std::size_t newWidth, std::size_t newHeight)
+	{
+		if (newWidth == width && newHeight == height)
+			return false;
+
+		width = newWidth;
+		height = newHeight;
+		image.assign(width * height, juce::PixelARGB(0, 0, 0, 0));
+		levels.assign(width + 8, 0);
+		firstShaded = endShaded = firstUploaded = endUploaded = 0;
+		uploadAll = true;
+
+		return true;
+	}
+
+	void PhosphorImage::reset()
+	{
+		resize(0, 0);
+		image.clear();
+		lastTick = 0;
+	}
+
+	double PhosphorImage::advance(double fadeMilliseconds)
+	{
+		auto const tick = juce::Time::getHighResolutionTicks();
+		auto const seconds = lastTick ? static_cast<double>(tick - lastTick) / juce::Time::getHighResolutionTicksPerSecond() : 0.0;
+		lastTick = tick;
+
+		return std::exp(-seconds * 1000 / fadeMilliseconds);
+	}
+
+	void PhosphorImage::beginFrame()
+	{
+		if (endShaded > firstShaded)
+			std::fill(image.begin() + firstShaded * width, image.begin() + endShaded * width, juce::PixelARGB(0, 0, 0, 0));
+
+		firstShaded = height;
+		endShaded = 0;
+	}
+
+	void PhosphorImage::addLevels(std::size_t row, juce::Colour colour)
+	{
+		const AFloat red = colour.getRed(), green = colour.getGreen(), blue = colour.getBlue();
+		const auto * rowLevels = levels.data();
+		auto * const pixels = image.data() + row * width;
+
+		for (std::size_t c = 0; c < width; ++c)
+		{
+			auto const level = rowLevels[c];
+
+			if (level <= 0)
+				continue;
+
+			auto add = [level](juce::uint8 current, AFloat component)
+			{
+				return static_cast<juce::uint8>(std::min<AFloat>(255, current + level * component));
+			};
+
+			auto & pixel = pixels[c];
+			// premultiplied, so the alpha stays above the other components
+			pixel.setARGB(add(pixel.getAlpha(), 255), add(pixel.getRed(), red), add(pixel.getGreen(), green), add(pixel.getBlue(), blue));
+		}
+
+		firstShaded = std::min(firstShaded, row);
+		endShaded = std::max(endShaded, row + 1);
+	}
+
+	void PhosphorImage::draw(cpl::OpenGLRendering::COpenGLStack & openGLStack)
+	{
+		if (!width || !height)
+			return;
+
+		if (!texture)
+		{
+			texture = std::make_unique<juce::OpenGLTexture>();
+			uploadAll = true;
+		}
+
+		if (uploadAll)
+		{
+			// rows are stored bottom up, like OpenGL expects
+			texture->loadARGB(image.data(), static_cast<int>(width), static_cast<int>(height));
+			uploadAll = false;
+		}
+		else
+		{
+			// rows shaded now, and rows shaded before that have to be cleared
+			auto first = firstShaded, end = endShaded;
+
+			if (endUploaded > firstUploaded)
+			{
+				first = std::min(first, firstUploaded);
+				end = std::max(end, endUploaded);
+			}
+
+			if (end > first)
+			{
+				texture->bind();
+				glTexSubImage2D(
+					GL_TEXTURE_2D, 0,
+					0, static_cast<GLint>(first),
+					static_cast<GLsizei>(width), static_cast<GLsizei>(end - first),
+					JUCE_RGBA_FORMAT, GL_UNSIGNED_BYTE,
+					image.data() + first * width
+				);
+				texture->unbind();
+			}
+		}
+
+		firstUploaded = firstShaded;
+		endUploaded = endShaded;
+
+		cpl::OpenGLRendering::ImageDrawer drawer(openGLStack, *texture);
+		drawer.setColour(juce::Colours::white);
+		drawer.drawAt({ -1, -1, 2, 2 });
+	}
+
+	void PhosphorImage::release()
+	{
+		texture = nullptr;
+		uploadAll = true;
+	}
+};
@@ -0,0 +1,183 @@
+/*************************************************************************************
+
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+
+	Copyright (C) 2016 Janus Lynggaard Thorborg (www.jthorborg.com)
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	See \licenses\ for additional details on licenses associated with this program.
+
+**************************************************************************************
+
+	file:PhosphorImage.h
+
+		Colour maps decaying hit densities into a texture, for the persistence
+		modes of the scopes.
+
+*************************************************************************************/
+
+#ifndef SIGNALIZER_PHOSPHORIMAGE_H
+	#define SIGNALIZER_PHOSPHORIMAGE_H
+
+	#include <cpl/rendering/OpenGLRasterizers.h>
+	#include <cpl/simd.h>
+	#include <memory>
+	#include <vector>
+	#include "CommonSignalizer.h"
+
+	namespace Signalizer
+	{
+		/// <summary>
+		/// Premultiplied image of one or more decaying density planes, drawn over the whole view.
+		/// The density planes are owned by the views, as they are laid out for how they are written.
+		/// Only rows that hold colour this or last frame are cleared, shaded and uploaded.
+		/// Must only be used by the rendering thread.
+		/// </summary>
+		class PhosphorImage
+		{
+		public:
+
+			/// <summary>
+			/// Resizes the image, and returns true if the size changed. The image is then empty,
+			/// and will be uploaded completely by the next draw().
+			/// </summary>
+			bool resize(std::size_t newWidth, std::size_t newHeight);
+
+			/// <summary>
+			/// Empties the image and restarts the timing, so the next frame starts over.
+			/// </summary>
+			void reset();
+
+			/// <summary>
+			/// Returns the factor densities decay by since the previous call, for a fade to about a third in
+			/// fadeMilliseconds. Returns one on the first call.
+			/// </summary>
+			double advance(double fadeMilliseconds);
+
+			/// <summary>
+			/// Multiplies the density plane by the factor. The plane must be aligned like cpl::aligned_vector<AFloat, 32>.
+			/// </summary>
+			template<typename ISA>
+			static void decay(AFloat * density, std::size_t size, AFloat factor) noexcept
+			{
+				using namespace cpl::simd;
+				typedef typename ISA::V V;
+
+				const V vFactor = set1<V>(factor);
+				auto const lanes = elements_of<V>::value;
+				std::size_t i = 0;
+
+				for (; i + lanes <= size; i += lanes)
+					store(load<V>(density + i) * vFactor, density + i);
+
+				for (; i < size; ++i)
+					density[i] *= factor;
+			}
+
+			/// <summary>
+			/// Starts a new frame of shading by clearing the rows that were shaded last.
+			/// </summary>
+			void beginFrame();
+
+			/// <summary>
+			/// Adds colour * x / (x + 1) to every pixel, where x is the density of the pixel times exposure, saturating.
+			/// The density is stored row major with getWidth() columns, with the bottom row first.
+			/// The levels of a row are computed in vectors, and rows without visible levels are skipped.
+			/// </summary>
+			template<typename ISA>
+			void shade(const AFloat * density, AFloat exposure, juce::Colour colour)
+			{
+				using namespace cpl::simd;
+				typedef typename ISA::V V;
+
+				auto const lanes = elements_of<V>::value;
+				const V vExposure = set1<V>(exposure), vOne = consts<V>::one, vVisible = set1<V>(VisibleLevel);
+				auto * const rowLevels = levels.data();
+
+				for (std::size_t r = 0; r < height; ++r)
+				{
+					const AFloat * row = density + r * width;
+					V vSum = zero<V>();
+					std::size_t c = 0;
+
+					for (; c + lanes <= width; c += lanes)
+					{
+						const V exposed = loadu<V>(row + c) * vExposure;
+						// also zeroes nans, as they never compare
+						const V level = vand((V)(exposed >= vVisible), exposed / (exposed + vOne));
+						store(level, rowLevels + c);
+						vSum += level;
+					}
+
+					suitable_container<V> sum = vSum;
+					AFloat total = 0;
+
+					for (std::size_t n = 0; n < lanes; ++n)
+						total += sum[n];
+
+					for (; c < width; ++c)
+					{
+						auto const exposed = row[c] * exposure;
+						rowLevels[c] = exposed >= VisibleLevel ? exposed / (exposed + 1) : 0;
+						total += rowLevels[c];
+					}
+
+					if (total > 0)
+						addLevels(r, colour);
+				}
+			}
+
+			/// <summary>
+			/// Uploads the rows that changed since the last draw, and draws the image over [-1, 1] with the current blending.
+			/// </summary>
+			void draw(cpl::OpenGLRendering::COpenGLStack & openGLStack);
+
+			/// <summary>
+			/// Frees the texture. Must be called while the OpenGL context is active.
+			/// </summary>
+			void release();
+
+			std::size_t getWidth() const noexcept { return width; }
+			std::size_t getHeight() const noexcept { return height; }
+
+		private:
+
+			/// <summary>
+			/// Below this, x / (x + 1) rounds to nothing in all components
+			/// </summary>
+			static constexpr AFloat VisibleLevel = 1.0f / 254;
+
+			/// <summary>
+			/// Adds the colour scaled by the levels to the pixels of the row
+			/// </summary>
+			void addLevels(std::size_t row, juce::Colour colour);
+
+			std::size_t width = 0, height = 0;
+			std::vector<juce::PixelARGB> image;
+			/// <summary>
+			/// The levels of the row being shaded, padded to whole vectors
+			/// </summary>
+			cpl::aligned_vector<AFloat, 32> levels;
+			std::unique_ptr<juce::OpenGLTexture> texture;
+			juce::int64 lastTick = 0;
+			/// <summary>
+			/// Rows [first, end) holding colour in the image, and in the texture
+			/// </summary>
+			std::size_t firstShaded = 0, endShaded = 0, firstUploaded = 0, endUploaded = 0;
+			bool uploadAll = true;
+		};
+	};
+
+#endif
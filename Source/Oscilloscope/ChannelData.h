@@ -34,6 +34,17 @@
 	#include <cpl/simd.h>
 	#include <cpl/dsp/LinkwitzRileyNetwork.h>
 	#include <cpl/dsp/SmoothedParameterState.h>
+	#include <algorithm>
+	#include <array>
+	#include <atomic>
+	#include <chrono>
+	#include <condition_variable>
+	#include <cstdint>
+	#include <limits>
+	#include <memory>
+	#include <mutex>
+	#include <thread>
+	#include <vector>
 
 	namespace Signalizer
 	{
@@ -43,12 +54,107 @@
 			typedef cpl::dsp::LinkwitzRileyNetwork<AFloat, Bands> Crossover;
 			typedef cpl::GraphicsND::UPixel<cpl::GraphicsND::ComponentOrder::OpenGL> PixelType;
 			typedef cpl::CLIFOStream<AFloat, 32> AudioBuffer;
-			typedef cpl::CLIFOStream<PixelType, 32> ColourBuffer;
+			/// <summary>
+			/// Colours are stored as the shares of the low (high byte) and mid (low byte) band energy out of 255;
+			/// the high band has the rest. They are turned into pixels by a ColourDecoder when drawn.
+			/// </summary>
+			typedef std::uint16_t ColourCode;
+			typedef cpl::CLIFOStream<ColourCode, 32> ColourBuffer;
+
+			static ColourCode encodeColour(const Crossover::BandArray & energies) noexcept
+			{
+				static_assert(Bands == 3, "Two shares are stored, the last band has the rest");
+
+				const auto sum = energies[0] + energies[1] + energies[2];
+
+				if (!(sum > 0))
+					return (85 << 8) | 85;
+
+				const auto scale = 255 / sum;
+				const auto low = std::min(255u, static_cast<unsigned>(energies[0] * scale + static_cast<AFloat>(0.5)));
+				const auto mid = std::min(255u - low, static_cast<unsigned>(energies[1] * scale + static_cast<AFloat>(0.5)));
+
+				return static_cast<ColourCode>((low << 8) | mid);
+			}
+
+			/// <summary>
+			/// Mixes the band colours by the energies of a colour code, and blends the result with a key.
+			/// </summary>
+			class ColourDecoder
+			{
+			public:
+
+				void design(const std::array<juce::Colour, Bands> & bandColours, juce::Colour colourKey, AFloat keyBlend)
+				{
+					for (std::size_t i = 0; i < Bands; ++i)
+						colours[i] = { bandColours[i].getFloatRed(), bandColours[i].getFloatGreen(), bandColours[i].getFloatBlue() };
+
+					key = PixelType(colourKey);
+					blend = keyBlend;
+				}
+
+				PixelType operator()(ColourCode code) const noexcept
+				{
+					typedef PixelType::ComponentType C;
+					constexpr auto PixelMax = static_cast<AFloat>(std::numeric_limits<C>::max());
+
+					const int low = code >> 8, mid = code & 0xFF;
+					const AFloat shares[Bands] = { static_cast<AFloat>(low), static_cast<AFloat>(mid), static_cast<AFloat>(std::max(0, 255 - low - mid)) };
+
+					AFloat red(0), green(0), blue(0);
+
+					for (std::size_t i = 0; i < Bands; ++i)
+					{
+						red += shares[i] * colours[i][0];
+						green += shares[i] * colours[i][1];
+						blue += shares[i] * colours[i][2];
+					}
+
+					const auto peak = std::max(red, std::max(blue, green));
+
+					if (!(peak > 0))
+						return key;
+
+					const auto invMax = PixelMax / peak;
+
+					PixelType ret;
+					ret.pixel.a = std::numeric_limits<C>::max();
+					ret.pixel.r = static_cast<C>(red * invMax);
+					ret.pixel.g = static_cast<C>(green * invMax);
+					ret.pixel.b = static_cast<C>(blue * invMax);
+
+					return ret.lerp(key, blend);
+				}
+
+			private:
+
+				std::array<std::array<AFloat, 3>, Bands> colours{};
+				PixelType key;
+				AFloat blend = 0;
+			};
+
+			/// <summary>
+			/// Which of the optional streams are allocated. Colours are only read when colouring by frequency,
+			/// and only for the channels of the current mode. The back buffer is only used by the preprocessing triggers.
+			/// </summary>
+			struct Allocation
+			{
+				std::array<bool, 2> channelColours{ { true, true } }, midSideColours{ { true, true } };
+				bool back = true;
+
+				bool operator == (const Allocation & other) const noexcept
+				{
+					return channelColours == other.channelColours && midSideColours == other.midSideColours && back == other.back;
+				}
+			};
+
+			typedef Signalizer::EnvelopePyramid EnvelopePyramid;
 
 			struct Channel
 			{
 				AudioBuffer audioData;
 				ColourBuffer colourData;
+				EnvelopePyramid envelope;
 			};
 
 			struct FilterStates
@@ -72,27 +178,111 @@
 			{
 				std::vector<Channel> channels{ 1 };
 				ColourBuffer midSideColour[2];
+				EnvelopePyramid midSideEnvelope[2];
+				/// <summary>
+				/// Total amount of samples ever written into this buffer
+				/// </summary>
+				std::uint64_t written = 0;
 
 				Channel & defaultChannel()
 				{
 					return channels[0];
 				}
 
-				void resizeStorage(std::size_t samples, std::size_t capacity = -1)
+				void resizeStorage(std::size_t samples, std::size_t capacity = -1, const Allocation & allocation = Allocation())
 				{
 					if (capacity == static_cast<std::size_t>(-1))
 						capacity = cpl::Math::nextPow2Inc(samples);
 
-					for (auto & c : channels)
+					auto resizeColours = [&](ColourBuffer & colours, bool allocated)
+					{
+						colours.setStorageRequirements(allocated ? samples : 0, allocated ? capacity : 0);
+					};
+
+					for (std::size_t i = 0; i < channels.size(); ++i)
 					{
+						auto & c = channels[i];
 						c.audioData.setStorageRequirements(samples, capacity);
-						c.colourData.setStorageRequirements(samples, capacity);
+						resizeColours(c.colourData, allocation.channelColours[std::min<std::size_t>(i, 1)]);
+						c.envelope.resize(capacity);
+					}
+
+					for (std::size_t i = 0; i < std::extent<decltype(midSideColour)>::value; ++i)
+					{
+						resizeColours(midSideColour[i], allocation.midSideColours[i]);
+					}
+
+					for (auto & e : midSideEnvelope)
+					{
+						e.resize(capacity);
 					}
+				}
+
+				/// <summary>
+				/// Adds the newest amount of samples in the audio buffers to the envelopes.
+				/// </summary>
+				void appendEnvelopes(std::size_t samples)
+				{
+					appendEnvelopes(*this, samples, 0);
+				}
 
-					for (auto & c : midSideColour)
+				/// <summary>
+				/// Adds the amount of samples ending lag samples before the head of the source's audio buffers to the envelopes.
+				/// </summary>
+				void appendEnvelopes(const Buffer & source, std::size_t samples, std::size_t lag)
+				{
+					auto forNewest = [samples, lag](const AudioBuffer::ProxyView & view, auto && func)
 					{
-						c.setStorageRequirements(samples, capacity);
+						auto const size = view.size();
+
+						if (lag >= size)
+							return;
+
+						auto const amount = std::min(samples, size - lag);
+
+						if (!amount)
+							return;
+
+						auto index = view.cursorPosition() + 2 * size - amount - lag;
+						while (index >= size)
+							index -= size;
+
+						for (std::size_t n = 0; n < amount; ++n)
+						{
+							func(index);
+							if (++index == size)
+								index = 0;
+						}
+					};
+
+					for (std::size_t c = 0; c < std::min(channels.size(), source.channels.size()); ++c)
+					{
+						auto && view = source.channels[c].audioData.createProxyView();
+						auto const data = view.begin();
+						auto & envelope = channels[c].envelope;
+						forNewest(view, [&](auto i) { envelope.add(data[i]); });
 					}
+
+					if (source.channels.size() < 2)
+						return;
+
+					auto && leftView = source.channels[0].audioData.createProxyView();
+					auto && rightView = source.channels[1].audioData.createProxyView();
+
+					if (leftView.size() != rightView.size())
+						return;
+
+					auto const left = leftView.begin();
+					auto const right = rightView.begin();
+
+					// same scaling as the mid/side sample evaluators
+					forNewest(leftView,
+						[&](auto i)
+						{
+							midSideEnvelope[0].add(static_cast<AFloat>(0.5) * (left[i] + right[i]));
+							midSideEnvelope[1].add(static_cast<AFloat>(0.5) * (left[i] - right[i]));
+						}
+					);
 				}
 			};
 
@@ -114,47 +304,799 @@
 						}
 
 						if (original > 0)
-							buffer->resizeStorage(channels.back().audioData.getSize(), channels.back().audioData.getCapacity());
+							buffer->resizeStorage(channels.back().audioData.getSize(), channels.back().audioData.getCapacity(), allocation);
 					}
 				}
 
 			}
 
-			void swapBuffers(std::size_t historySize, cpl::ssize_t offset)
+			/// <summary>
+			/// Resizes the front and back buffers, only allocating the streams in use. The back buffer is given slack,
+			/// so published windows survive while the next one is being captured. Reverts to reading the front buffer
+			/// if the size or allocation changed.
+			/// </summary>
+			void resizeStorage(std::size_t samples, std::size_t capacity, const Allocation & newAllocation)
 			{
-				auto swapBuf = [historySize, offset](const auto & inBuf, auto & outBuf)
+				if (front.channels.empty() || front.channels[0].audioData.getSize() != samples || !(allocation == newAllocation))
 				{
-					outBuf.createWriter().copyIntoHead(inBuf.createProxyView(), historySize, offset);
+					backIsPublished = false;
+					version++;
+				}
+
+				allocation = newAllocation;
+
+				front.resizeStorage(samples, capacity, allocation);
+
+				if (allocation.back)
+					back.resizeStorage(samples * 2, std::max(samples * 2, capacity), allocation);
+				else
+					back.resizeStorage(0, 0, allocation);
+			}
+
+			const Allocation & getAllocation() const noexcept
+			{
+				return allocation;
+			}
+
+			/// <summary>
+			/// Publishes the newest historySize samples of the back buffer ending lag samples before its head
+			/// as the current read window. No samples are moved, only the front envelopes are updated.
+			/// </summary>
+			void publishBack(std::size_t historySize, std::size_t lag)
+			{
+				front.appendEnvelopes(back, historySize, lag);
+				publishedEnd = back.written - std::min<std::uint64_t>(lag, back.written);
+				backIsPublished = true;
+				version++;
+				publishedWindows++;
+			}
+
+			/// <summary>
+			/// Makes the front buffer the read window, for modes that write directly into it.
+			/// </summary>
+			void publishFront() noexcept
+			{
+				if (backIsPublished)
+					version++;
+
+				backIsPublished = false;
+			}
+
+			/// <summary>
+			/// Must be called before writing samples into the back buffer. If the write would overrun a published window,
+			/// the window is moved into the front buffer first - this only happens if nothing is published for a long time.
+			/// </summary>
+			void reserveBack(std::size_t samples)
+			{
+				if (!backIsPublished)
+					return;
+
+				auto const lag = getPublishedLag();
+				auto const window = front.channels[0].audioData.getSize();
+				auto const room = back.channels[0].audioData.getSize();
+
+				if (lag + samples + window <= room)
+					return;
+
+				auto const amount = std::min(window, room - std::min(room, lag));
+				auto const offset = -static_cast<cpl::ssize_t>(lag);
+
+				auto copy = [amount, offset](const auto & inBuf, auto & outBuf)
+				{
+					if (inBuf.getSize() && outBuf.getSize())
+						outBuf.createWriter().copyIntoHead(inBuf.createProxyView(), amount, offset);
 				};
 
 				for (std::size_t i = 0; i < std::extent<decltype(Buffer::midSideColour)>::value; ++i)
 				{
-					swapBuf(back.midSideColour[i], front.midSideColour[i]);
+					copy(back.midSideColour[i], front.midSideColour[i]);
 				}
 
 				for (std::size_t i = 0; i < back.channels.size(); ++i)
 				{
-					swapBuf(back.channels[i].audioData, front.channels[i].audioData);
-					swapBuf(back.channels[i].colourData, front.channels[i].colourData);
+					copy(back.channels[i].audioData, front.channels[i].audioData);
+					copy(back.channels[i].colourData, front.channels[i].colourData);
+				}
+
+				backIsPublished = false;
+				version++;
+			}
+
+			/// <summary>
+			/// The buffer holding the current read window. Its newest sample is getPublishedLag() samples before the head.
+			/// </summary>
+			Buffer & getPublishedBuffer() noexcept
+			{
+				return backIsPublished ? back : front;
+			}
+
+			std::size_t getPublishedLag() const noexcept
+			{
+				return backIsPublished ? static_cast<std::size_t>(back.written - publishedEnd) : 0;
+			}
+
+			/// <summary>
+			/// Changes whenever the contents of the read window may have changed.
+			/// </summary>
+			std::uint64_t getVersion() const noexcept
+			{
+				return version + front.written;
+			}
+
+			/// <summary>
+			/// The amount of windows published by publishBack() so far, including the ones replaced before being read.
+			/// </summary>
+			std::uint64_t getPublishedWindows() const noexcept
+			{
+				return publishedWindows;
+			}
+
+			/// <summary>
+			/// Copies the read window, envelopes and default keys of source into the front buffer of this object,
+			/// so it can be read while source keeps being written to. Pass the version of source as of the last
+			/// capture; the samples are only copied again if it changed.
+			/// </summary>
+			void captureSnapshot(ChannelData & source, std::uint64_t & capturedVersion)
+			{
+				captureKeys(source);
+
+				auto const sourceVersion = source.getVersion();
+
+				if (sourceVersion == capturedVersion && front.channels.size() == source.front.channels.size())
+					return;
+
+				capturedVersion = sourceVersion;
+
+				auto & published = source.getPublishedBuffer();
+				auto const window = source.front.channels[0].audioData.getSize();
+				auto const offset = -static_cast<cpl::ssize_t>(source.getPublishedLag());
+
+				while (front.channels.size() < published.channels.size())
+					front.channels.emplace_back();
+
+				while (front.channels.size() > published.channels.size())
+					front.channels.pop_back();
+
+				// the envelopes are sized exactly like copyNewest() does, so this doesn't clear them every time
+				front.resizeStorage(window, window, allocation);
+
+				auto copy = [window, offset](const auto & inBuf, auto & outBuf)
+				{
+					if (inBuf.getSize() && outBuf.getSize())
+						outBuf.createWriter().copyIntoHead(inBuf.createProxyView(), window, offset);
+				};
+
+				for (std::size_t i = 0; i < std::extent<decltype(Buffer::midSideColour)>::value; ++i)
+				{
+					copy(published.midSideColour[i], front.midSideColour[i]);
+					front.midSideEnvelope[i].copyNewest(source.front.midSideEnvelope[i], window);
 				}
+
+				for (std::size_t i = 0; i < front.channels.size(); ++i)
+				{
+					copy(published.channels[i].audioData, front.channels[i].audioData);
+					copy(published.channels[i].colourData, front.channels[i].colourData);
+					front.channels[i].envelope.copyNewest(source.front.channels[i].envelope, window);
+				}
+
+				front.written = source.front.written;
 			}
 
+			/// <summary>
+			/// Copies the channel count, allocation and default keys of source.
+			/// </summary>
+			void captureKeys(const ChannelData & source)
+			{
+				allocation = source.allocation;
+				filterStates.channels.resize(source.filterStates.channels.size());
+
+				for (std::size_t i = 0; i < filterStates.channels.size(); ++i)
+					filterStates.channels[i].defaultKey = source.filterStates.channels[i].defaultKey;
+			}
+
+			/// <summary>
+			/// Designs the decoders of the colour streams, for the primary and secondary key.
+			/// The channel colour streams and mid/side streams use the key of their index.
+			/// </summary>
+			void designColours(const std::array<juce::Colour, Bands> & bandColours, juce::Colour primary, juce::Colour secondary, AFloat keyBlend)
+			{
+				colourDecoders[0].design(bandColours, primary, keyBlend);
+				colourDecoders[1].design(bandColours, secondary, keyBlend);
+			}
+
+			/// <summary>
+			/// Redesigns the crossover network, if any of the arguments changed since last time.
+			/// </summary>
 			void tuneCrossOver(double lowCrossover, double highCrossover, double sampleRate)
 			{
+				if (lowCrossover == crossoverDesign[0] && highCrossover == crossoverDesign[1] && sampleRate == crossoverDesign[2])
+					return;
+
 				networkCoeffs = Crossover::Coefficients::design({ static_cast<AFloat>(lowCrossover / sampleRate), static_cast<AFloat>(highCrossover / sampleRate) });
+				crossoverDesign = { lowCrossover, highCrossover, sampleRate };
 			}
 
+			/// <summary>
+			/// Redesigns the colour smoothing pole, if any of the arguments changed since last time.
+			/// </summary>
 			void tuneColourSmoothing(double milliseconds, double sampleRate)
 			{
+				if (milliseconds == smoothingDesign[0] && sampleRate == smoothingDesign[1])
+					return;
+
 				smoothFilterPole = cpl::dsp::SmoothedParameterState<AFloat, 1>::design(milliseconds, sampleRate);
+				smoothingDesign = { milliseconds, sampleRate };
 			}
 
 			Crossover::Coefficients networkCoeffs;
 			cpl::dsp::SmoothedParameterState<AFloat, 1>::PoleState smoothFilterPole;
 
+			/// <summary>
+			/// Per-block scratch of the crossover outputs for the left and right channels.
+			/// Only grows, and is only valid for the block currently being processed.
+			/// </summary>
+			std::array<std::vector<Crossover::BandArray>, 2> bands;
+
 			FilterStates filterStates;
 			Buffer back, front;
+			std::array<ColourDecoder, 2> colourDecoders;
+
+		private:
+
+			Allocation allocation;
+
+			bool backIsPublished = false;
+			std::uint64_t publishedEnd = 0, version = 0, publishedWindows = 0;
+
+			std::array<double, 3> crossoverDesign{ -1, -1, -1 };
+			std::array<double, 2> smoothingDesign{ -1, -1 };
+
+		};
+
+		/// <summary>
+		/// Long history of the audio and colour streams for scrolling back, kept in a preallocated memory mapped
+		/// ring file instead of RAM. Whole pages of frames also get min/max summaries, so the entire capture can be
+		/// drawn without touching the file. The audio thread only queues frames through a preallocated single producer /
+		/// single consumer ring; a worker owns the file, writes the queued frames into it and creates and deletes storage.
+		/// The renderer reads windows outside the lock, from the frames the worker isn't writing.
+		/// </summary>
+		class DiskCapture
+		{
+		public:
+
+			static const std::size_t Channels = 2;
+			/// <summary>
+			/// The colour streams of both channels, then mid and side
+			/// </summary>
+			static const std::size_t ColourStreams = 4;
+			static const std::size_t PageFrames = 4096;
+			/// <summary>
+			/// How far the audio thread can get ahead of the worker, before frames are dropped. A power of two.
+			/// </summary>
+			static const std::size_t QueueFrames = 1 << 16;
+
+			typedef std::array<ChannelData::EnvelopePyramid::Extremes, Channels> PageSummary;
+
+			/// <summary>
+			/// A preallocated file in the temporary directory, mapped into memory. The file is deleted again when this is destroyed.
+			/// Laid out as one plane per audio channel, followed by one plane per colour stream.
+			/// </summary>
+			class Storage
+			{
+			public:
+
+				/// <summary>
+				/// Creates storage for at least the amount of frames, rounded up to whole pages.
+				/// Returns null if the file couldn't be created or mapped. Slow, as the whole file is written and
+				/// mapped in - only done by the worker of the capture.
+				/// </summary>
+				static std::unique_ptr<Storage> create(std::size_t frames)
+				{
+					std::unique_ptr<Storage> ret(new Storage());
+					ret->frames = roundToPages(frames);
+
+					const auto bytes = static_cast<juce::int64>(ret->frames * (Channels * sizeof(AFloat) + ColourStreams * sizeof(ChannelData::ColourCode)));
+
+					ret->file = juce::File::getSpecialLocation(juce::File::tempDirectory).getNonexistentChildFile("Signalizer", ".capture");
+
+					{
+						juce::FileOutputStream stream(ret->file);
+
+						if (stream.failedToOpen())
+							return nullptr;
+
+						// actually allocate the blocks, so the capture can't run out of disk space later on
+						std::vector<char> zeroes(1 << 16);
+
+						for (juce::int64 allocated = 0; allocated < bytes; allocated += zeroes.size())
+						{
+							if (!stream.write(zeroes.data(), static_cast<std::size_t>(std::min<juce::int64>(zeroes.size(), bytes - allocated))))
+								return nullptr;
+						}
+					}
+
+					ret->mapping = std::make_unique<juce::MemoryMappedFile>(ret->file, juce::MemoryMappedFile::readWrite);
+
+					if (!ret->mapping->getData() || ret->mapping->getSize() < static_cast<std::size_t>(bytes))
+						return nullptr;
+
+					// touch every page now, so the worker and readWindow() don't fault them in while the lock is held
+					const auto data = static_cast<const volatile char *>(ret->mapping->getData());
+
+					for (std::size_t i = 0; i < static_cast<std::size_t>(bytes); i += 4096)
+						static_cast<void>(data[i]);
+
+					return ret;
+				}
+
+				static std::size_t roundToPages(std::size_t frames) noexcept
+				{
+					return std::max<std::size_t>(1, (frames + PageFrames - 1) / PageFrames) * PageFrames;
+				}
+
+				~Storage()
+				{
+					mapping = nullptr;
+					file.deleteFile();
+				}
+
+				std::size_t getFrames() const noexcept { return frames; }
+
+				AFloat * audio(std::size_t channel) noexcept
+				{
+					return static_cast<AFloat *>(mapping->getData()) + channel * frames;
+				}
+
+				ChannelData::ColourCode * colours(std::size_t stream) noexcept
+				{
+					return reinterpret_cast<ChannelData::ColourCode *>(audio(Channels)) + stream * frames;
+				}
+
+			private:
+
+				Storage() = default;
+
+				juce::File file;
+				std::unique_ptr<juce::MemoryMappedFile> mapping;
+				std::size_t frames = 0;
+			};
+
+			~DiskCapture()
+			{
+				if (!worker.joinable())
+					return;
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					quit = true;
+				}
+
+				wake.notify_one();
+				worker.join();
+			}
+
+			/// <summary>
+			/// Asks for a capture of the amount of frames, or for no capture if zero. The worker starts it over in new storage
+			/// once that is created; until then, nothing is captured. Does nothing if that was already requested.
+			/// Not for the audio thread, as the queue and the worker are created on the first request.
+			/// </summary>
+			void request(std::size_t frames)
+			{
+				if (frames == requested)
+					return;
+
+				requested = frames;
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					wanted = frames;
+					pending = true;
+
+					// never released again, as the audio thread may still be writing to it
+					if (frames && queue.empty())
+						queue.resize(QueueFrames);
+				}
+
+				if (!worker.joinable())
+					worker = std::thread([this] { run(); });
+
+				wake.notify_one();
+			}
+
+			/// <summary>
+			/// Absolute positions of captured frames, counted from the first frame ever captured. [oldest, newest)
+			/// </summary>
+			struct Range
+			{
+				std::uint64_t oldest, newest;
+
+				std::size_t size() const noexcept { return static_cast<std::size_t>(newest - oldest); }
+			};
+
+			/// <summary>
+			/// The frames that can be read back. A page is left between it and the frames the worker overwrites next,
+			/// so a window read from it isn't overwritten while it is copied.
+			/// </summary>
+			Range getRange()
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				return readable(PageFrames);
+			}
+
+			/// <summary>
+			/// Queues a block of audio for the worker, together with the newest colours of the streams in colourSource.
+			/// Frames of the block older than the colour buffers hold the oldest colour available.
+			/// Mono input is stored in both channels. Only for the audio thread: it never waits, nor allocates, and if the
+			/// worker falls QueueFrames behind, only the newest frames of the block that fit are kept.
+			/// </summary>
+			void append(const AFloat * const * audio, std::size_t numChannels, const ChannelData::Buffer & colourSource, std::size_t samples)
+			{
+				if (!accepting.load(std::memory_order_acquire) || numChannels == 0 || samples == 0)
+					return;
+
+				const auto head = queueHead.load(std::memory_order_relaxed);
+				const auto space = QueueFrames - static_cast<std::size_t>(head - queueTail.load(std::memory_order_acquire));
+
+				const auto skip = samples > space ? samples - space : 0;
+				samples -= skip;
+
+				if (samples == 0)
+					return;
+
+				const auto mask = QueueFrames - 1;
+
+				for (std::size_t c = 0; c < Channels; ++c)
+				{
+					const auto source = audio[std::min(c, numChannels - 1)] + skip;
+
+					for (std::size_t n = 0; n < samples; ++n)
+						queue[(head + n) & mask].audio[c] = source[n];
+				}
+
+				auto appendColours = [&](const ChannelData::ColourBuffer & stream, std::size_t s)
+				{
+					auto && view = stream.createProxyView();
+					const auto size = view.size();
+
+					if (size == 0)
+						return;
+
+					const auto amount = std::min(samples, size);
+					const auto missing = samples - amount;
+					const auto colours = view.begin();
+
+					auto index = (view.cursorPosition() + size - amount) % size;
+
+					for (std::size_t n = 0; n < samples; ++n)
+					{
+						queue[(head + n) & mask].colours[s] = colours[index];
+
+						if (n >= missing && ++index == size)
+							index = 0;
+					}
+				};
+
+				for (std::size_t c = 0; c < Channels; ++c)
+					appendColours(colourSource.channels[std::min(c, colourSource.channels.size() - 1)].colourData, c);
+
+				for (std::size_t i = 0; i < std::extent<decltype(ChannelData::Buffer::midSideColour)>::value; ++i)
+					appendColours(colourSource.midSideColour[i], Channels + i);
+
+				queueHead.store(head + samples, std::memory_order_release);
+			}
+
+			/// <summary>
+			/// Reads the window of frames ending at the absolute position end (clamped to getRange()) into the front buffer
+			/// of target, replacing its streams and rebuilding its envelopes. Call ChannelData::captureKeys() first, as the
+			/// amount of channels read is taken from it. Like ChannelData::captureSnapshot(), nothing is read if
+			/// capturedVersion shows this was already read. The frames are copied without holding the lock, so the worker
+			/// keeps writing meanwhile. Returns false if nothing can be read.
+			/// </summary>
+			bool readWindow(ChannelData & target, std::size_t window, std::uint64_t end, std::uint64_t & capturedVersion)
+			{
+				const auto channels = std::max<std::size_t>(1, std::min(static_cast<std::size_t>(Channels), target.filterStates.channels.size()));
+				Storage * source = nullptr;
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+
+					const auto range = readable(PageFrames);
+
+					if (range.size() == 0 || window == 0)
+						return false;
+
+					window = std::min(window, range.size());
+					end = std::min(std::max(end, range.oldest + window), range.newest);
+
+					// never equal to the versions of live windows
+					const auto version = end | (std::uint64_t(1) << 63);
+					auto & front = target.front;
+
+					if (version == capturedVersion && front.channels.size() == channels && front.channels[0].audioData.getSize() == window)
+						return true;
+
+					capturedVersion = version;
+					source = storage.get();
+					// the worker doesn't replace the storage while it is read
+					reading = true;
+				}
+
+				copyWindow(*source, target, channels, window, end);
+
+				bool intact = false;
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					reading = false;
+					// only if the worker lapped the page of margin while copying
+					intact = end - window >= readable(0).oldest;
+				}
+
+				idle.notify_all();
+
+				// read it again next time
+				if (!intact)
+					capturedVersion = ~std::uint64_t(0);
+
+				return true;
+			}
+
+			/// <summary>
+			/// Copies the summaries of the complete pages, oldest first.
+			/// </summary>
+			void copySummaries(std::vector<PageSummary> & output)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				output.clear();
+
+				if (pages.empty())
+					return;
+
+				// the oldest page is left out, as it is already being overwritten
+				const auto newest = written / PageFrames;
+				const auto complete = std::min<std::uint64_t>(newest - start / PageFrames, pages.size() - 1);
+
+				for (auto i = newest - complete; i < newest; ++i)
+					output.push_back(pages[static_cast<std::size_t>(i % pages.size())]);
+			}
+
+		private:
+
+			/// <summary>
+			/// The frames that can be read, leaving out the page the worker writes next and margin frames more. Called with the lock held.
+			/// </summary>
+			Range readable(std::uint64_t margin) const noexcept
+			{
+				if (!storage)
+					return { written, written };
+
+				const auto reserved = PageFrames + margin;
+				const auto frames = storage->getFrames();
+				const auto overwritten = written + reserved > frames ? written + reserved - frames : 0;
+
+				return { std::min(std::max(start, overwritten), written), written };
+			}
+
+			/// <summary>
+			/// See readWindow().
+			/// </summary>
+			static void copyWindow(Storage & source, ChannelData & target, std::size_t channels, std::size_t window, std::uint64_t end)
+			{
+				auto & front = target.front;
+
+				while (front.channels.size() < channels)
+					front.channels.emplace_back();
+
+				while (front.channels.size() > channels)
+					front.channels.pop_back();
+
+				front.resizeStorage(window, window, target.getAllocation());
+
+				const auto frames = source.getFrames();
+				const auto position = static_cast<std::size_t>((end - window) % frames);
+				const auto first = std::min(window, frames - position);
+
+				auto read = [&](const auto * plane, auto & stream)
+				{
+					if (stream.getSize() == 0)
+						return;
+
+					auto && writer = stream.createWriter();
+					writer.copyIntoHead(plane + position, first);
+
+					if (window > first)
+						writer.copyIntoHead(plane, window - first);
+				};
+
+				for (std::size_t c = 0; c < channels; ++c)
+				{
+					read(source.audio(c), front.channels[c].audioData);
+					read(source.colours(c), front.channels[c].colourData);
+				}
+
+				for (std::size_t i = 0; i < std::extent<decltype(ChannelData::Buffer::midSideColour)>::value; ++i)
+					read(source.colours(Channels + i), front.midSideColour[i]);
+
+				// same scaling as ChannelData::Buffer::appendEnvelopes()
+				const auto left = source.audio(0), right = source.audio(channels - 1);
+
+				for (std::size_t c = 0; c < channels; ++c)
+					front.channels[c].envelope.clear();
+
+				for (auto & e : front.midSideEnvelope)
+					e.clear();
+
+				for (std::size_t n = 0, index = position; n < window; ++n)
+				{
+					for (std::size_t c = 0; c < channels; ++c)
+						front.channels[c].envelope.add(source.audio(c)[index]);
+
+					if (channels > 1)
+					{
+						front.midSideEnvelope[0].add(static_cast<AFloat>(0.5) * (left[index] + right[index]));
+						front.midSideEnvelope[1].add(static_cast<AFloat>(0.5) * (left[index] - right[index]));
+					}
+
+					if (++index == frames)
+						index = 0;
+				}
+
+				front.written = end;
+			}
+
+			struct Frame
+			{
+				AFloat audio[Channels];
+				ChannelData::ColourCode colours[ColourStreams];
+			};
+
+			void run()
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+
+				while (true)
+				{
+					auto ready = [this] { return quit || pending; };
+
+					// while capturing, the queue is polled so the audio thread never has to wake the worker
+					if (storage)
+						wake.wait_for(lock, std::chrono::milliseconds(PollInterval), ready);
+					else
+						wake.wait(lock, ready);
+
+					if (quit)
+						return;
+
+					if (pending)
+					{
+						const auto frames = wanted;
+						pending = false;
+						accepting.store(false, std::memory_order_release);
+
+						idle.wait(lock, [this] { return !reading; });
+						auto garbage = std::move(storage);
+						pages.clear();
+
+						lock.unlock();
+
+						garbage = nullptr;
+
+						std::unique_ptr<Storage> created;
+						std::vector<PageSummary> createdPages;
+
+						if (frames && (created = Storage::create(frames)))
+							createdPages.assign(created->getFrames() / PageFrames, PageSummary{});
+
+						lock.lock();
+
+						// (if this was superseded in the meantime, it is replaced on the next pass)
+						storage = std::move(created);
+						pages = std::move(createdPages);
+						// positions keep counting, but a capture starts on a page
+						start = written = (written + PageFrames - 1) / PageFrames * PageFrames;
+
+						// frames queued before the capture started are discarded
+						queueTail.store(queueHead.load(std::memory_order_acquire), std::memory_order_release);
+						accepting.store(storage != nullptr, std::memory_order_release);
+
+						continue;
+					}
+
+					if (storage)
+						drain(lock);
+				}
+			}
+
+			/// <summary>
+			/// Writes the queued frames into the storage, and summarises the pages they complete. Called with the lock held,
+			/// which is released while the frames are written - readers stay out of the page written next, see readable().
+			/// </summary>
+			void drain(std::unique_lock<std::mutex> & lock)
+			{
+				const auto head = queueHead.load(std::memory_order_acquire);
+				const auto frames = storage->getFrames();
+				const auto mask = QueueFrames - 1;
+				auto tail = queueTail.load(std::memory_order_relaxed);
+
+				while (tail != head)
+				{
+					const auto position = static_cast<std::size_t>(written % frames);
+					// chunks end at page boundaries, so they are contiguous in the file
+					const auto chunk = static_cast<std::size_t>(std::min<std::uint64_t>(head - tail, PageFrames - position % PageFrames));
+
+					lock.unlock();
+
+					for (std::size_t c = 0; c < Channels; ++c)
+					{
+						const auto plane = storage->audio(c) + position;
+						auto & extremes = summary[c];
+
+						for (std::size_t n = 0; n < chunk; ++n)
+						{
+							const auto sample = queue[(tail + n) & mask].audio[c];
+							plane[n] = sample;
+
+							if ((position + n) % PageFrames == 0)
+							{
+								extremes = { sample, sample };
+							}
+							else
+							{
+								extremes.low = std::min(extremes.low, sample);
+								extremes.high = std::max(extremes.high, sample);
+							}
+						}
+					}
+
+					for (std::size_t s = 0; s < ColourStreams; ++s)
+					{
+						const auto plane = storage->colours(s) + position;
+
+						for (std::size_t n = 0; n < chunk; ++n)
+							plane[n] = queue[(tail + n) & mask].colours[s];
+					}
+
+					lock.lock();
+
+					written += chunk;
+					tail += chunk;
+					queueTail.store(tail, std::memory_order_release);
+
+					if (written % PageFrames == 0)
+						pages[static_cast<std::size_t>((written / PageFrames - 1) % pages.size())] = summary;
+				}
+			}
+
+			static const int PollInterval = 5;
+
+			std::mutex mutex;
+			std::condition_variable wake, idle;
+			std::thread worker;
+			bool quit = false, pending = false, reading = false;
+			std::size_t wanted = 0;
+			/// <summary>
+			/// Only touched by the thread calling request()
+			/// </summary>
+			std::size_t requested = 0;
+
+			/// <summary>
+			/// Guarded by the mutex, and only replaced by the worker. written and start are absolute positions, see Range.
+			/// </summary>
+			std::unique_ptr<Storage> storage;
+			std::vector<PageSummary> pages;
+			std::uint64_t written = 0, start = 0;
+			/// <summary>
+			/// The summary of the page being written. Only touched by the worker.
+			/// </summary>
+			PageSummary summary{};
 
+			/// <summary>
+			/// Written by the audio thread at queueHead, read by the worker at queueTail
+			/// </summary>
+			std::vector<Frame> queue;
+			std::atomic<std::uint64_t> queueHead{ 0 }, queueTail{ 0 };
+			std::atomic<bool> accepting{ false };
 		};
 	};
 
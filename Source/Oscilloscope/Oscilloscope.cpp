@@ -35,6 +35,7 @@
 #include <cpl/rendering/OpenGLRasterizers.h>
 #include <cpl/simd.h>
 #include <cpl/LexicalConversion.h>
+#include "SampleColourEvaluators.h"
 #include "OscilloscopeDSP.inl"
 #include "StreamPreprocessing.h"
 
@@ -48,6 +49,8 @@ namespace Signalizer
 
     constexpr std::size_t OscilloscopeContent::LookaheadSize;
     constexpr std::size_t OscilloscopeContent::InterpolationKernelSize;
+	constexpr std::size_t Oscilloscope::PitchAnalysis::MinimumSize;
+	constexpr std::size_t Oscilloscope::PitchAnalysis::PeriodsPerAnalysis;
     
 
 	Oscilloscope::Oscilloscope(const SharedBehaviour & globalBehaviour, const std::string & nameId, AudioStream & data, ProcessorState * params)
@@ -71,12 +74,17 @@ namespace Signalizer
 
 		triggerState.preprocessingTrigger = std::make_unique<PreprocessingTrigger>();
 
-		transformBuffer.resize(OscilloscopeContent::LookaheadSize);
+		// real transforms are computed through a half sized complex transform
+		transformBuffer.resize((OscilloscopeContent::LookaheadSize >> 1) + 1);
 		temporaryBuffer.resize(OscilloscopeContent::LookaheadSize);
 
+		pitchAnalysis.twiddles.resize(OscilloscopeContent::LookaheadSize >> 1);
+		for (std::size_t k = 0; k < pitchAnalysis.twiddles.size(); ++k)
+			pitchAnalysis.twiddles[k] = std::polar(1.0, -cpl::simd::consts<double>::tau * k / OscilloscopeContent::LookaheadSize);
+
 		mtFlags.firstRun = true;
 		setOpaque(true);
-		textbuf = std::unique_ptr<char>(new char[400]);
+		textbuf = std::unique_ptr<char>(new char[512]);
 		processorSpeed = cpl::system::CProcessor::getMHz();
 		initPanelAndControls();
 		listenToSource(audioStream);
@@ -299,6 +307,10 @@ namespace Signalizer
 		state.colourBackground = content->backgroundColour.getAsJuceColour();
 		state.colourGraph = content->graphColour.getAsJuceColour();
 		state.colourTracker = content->trackerColour.getAsJuceColour();
+		state.colourLow = content->lowColour.getAsJuceColour();
+		state.colourMid = content->midColour.getAsJuceColour();
+		state.colourHigh = content->highColour.getAsJuceColour();
+		state.colourBlend = 1 - content->frequencyColouringBlend.parameter.getValue();
 
 		state.timeMode = cpl::enum_cast<OscilloscopeContent::TimeMode>(content->timeMode.param.getTransformedValue());
 		state.beatDivision = windowValue;
@@ -307,6 +319,10 @@ namespace Signalizer
 
 		state.triggerHysteresis = content->triggerHysteresis.parameter.getValue();
 		state.triggerThreshold = content->triggerThreshold.getTransformedValue();
+		state.persistence = content->persistence.getNormalizedValue() > 0.5;
+		state.persistenceDecay = content->persistenceDecay.getTransformedValue();
+		state.diskCapture = content->diskCapture.getNormalizedValue() > 0.5;
+		state.scrollback = content->scrollback.getTransformedValue();
 
 		cpl::foreach_enum<VO>([this](auto i) {
 			state.viewOffsets[i] = content->viewOffsets[i].getTransformedValue();
@@ -129,22 +129,101 @@
 			template<typename ISA, typename Eval>
 				void drawWavePlot(cpl::OpenGLRendering::COpenGLStack &);
 
+			/// <summary>
+			/// Where the displayed window starts in the sample buffers, and how samples map to the horizontal unit space.
+			/// </summary>
+			struct SampleSpace
+			{
+				cpl::ssize_t roundedWindow, quantizedCycleSamples, bufferOffset;
+				double sampleDisplacement, offset;
+			};
+
+			SampleSpace calculateSampleSpace(SubSampleInterpolation interpolation) const noexcept;
+
+			/// <summary>
+			/// Rasterizes the current window of the evaluator into its persistence image, instead of drawing it.
+			/// </summary>
+			template<typename ISA, typename Evaluator>
+				void accumulatePersistence();
+
+			/// <summary>
+			/// Decays the persistence images by the time since the last frame.
+			/// </summary>
+			template<typename ISA>
+				void decayPersistence();
+
+			/// <summary>
+			/// Colour maps the persistence images and draws them over the view.
+			/// </summary>
+			template<typename ISA>
+				void drawPersistence(cpl::OpenGLRendering::COpenGLStack &);
+
+			/// <summary>
+			/// Transforms count samples of the evaluator starting at offset (see startFrom()) into x/y pairs in vertexBuffer,
+			/// with x in sample space. Steps produces two vertices per sample, for rectangular interpolation.
+			/// Colours are copied from the evaluator if coloured is set. Returns the amount of vertices generated.
+			/// </summary>
+			template<typename ISA, typename Evaluator>
+				std::size_t generateVertices(const Evaluator & eval, cpl::ssize_t offset, std::size_t count, bool steps, bool coloured);
+
+			/// <summary>
+			/// Draws the first vertices of vertexBuffer as primitives, with per-vertex colours if coloured is set
+			/// and otherwise the key. Line strips are drawn through the lineStream with the view transform, if it could be created.
+			/// </summary>
+			void drawVertices(GLenum primitive, std::size_t vertices, bool coloured, ChannelData::PixelType key, const LineTransform & view);
+
+			/// <summary>
+			/// Draws the page summaries of the disk capture along the bottom of the view, and marks the displayed window.
+			/// </summary>
+			void drawCaptureOverview(cpl::OpenGLRendering::COpenGLStack &);
+
 			template<typename ISA>
 				void drawWireFrame(juce::Graphics & g, juce::Rectangle<float> rect, float gain);
 
 			template<typename ISA>
 				void drawTimeDivisions(juce::Graphics & g, juce::Rectangle<float> rect);
 
-			template<typename ISA, typename Eval>
-				void calculateFundamentalPeriod();
+			/// <summary>
+			/// Reads the latest pitch estimate into triggerState. Requires bufferLock.
+			/// </summary>
+			void calculateFundamentalPeriod();
 
 			template<typename ISA, typename Eval>
 				void calculateTriggeringOffset();
 
+			/// <summary>
+			/// Runs estimatePitch() on the audio thread once enough new samples arrived,
+			/// for pitch tracking triggering modes.
+			/// </summary>
+			template<typename ISA>
+				void runPitchAnalysis(std::size_t numSamples);
+
+			template<typename ISA, typename Eval>
+				void estimatePitch();
+
+			/// <summary>
+			/// Spectral peak picking, for TriggeringMode::Spectral
+			/// </summary>
+			template<typename ISA, typename Eval>
+				void estimateFundamental();
+
+			/// <summary>
+			/// YIN estimation of the period, for TriggeringMode::Pitch
+			/// </summary>
+			template<typename ISA, typename Eval>
+				void estimatePeriod();
+
+			/// <summary>
+			/// Median filters the estimate and stores it in pitchAnalysis.record
+			/// </summary>
+			void publishFundamental(BinRecord estimate);
+
 			void resizeAudioStorage();
 
-			template<typename ISA>
-				void runPeakFilter();
+			/// <summary>
+			/// Decays the auto-gain envelope towards the peak of the displayed window.
+			/// </summary>
+			void runPeakFilter();
 
 			template<typename ISA, typename Eval>
 				void analyseAndSetupState();
@@ -207,8 +286,9 @@
 			// contains frame-updated non-atomic structures
 			struct StateOptions
 			{
-				bool isFrozen, antialias, diagnostics, dotSamples, customTrigger, overlayChannels, colourChannelsByFrequency, drawCursorTracker, isSuspended;
+				bool isFrozen, antialias, diagnostics, dotSamples, customTrigger, overlayChannels, colourChannelsByFrequency, drawCursorTracker, isSuspended, persistence, diskCapture;
 				float primitiveSize;
+				double persistenceDecay, scrollback, colourBlend;
 
 				double effectiveWindowSize;
 				double windowTimeOffset;
@@ -220,7 +300,7 @@
 
 				double viewOffsets[4];
 				std::int64_t transportPosition;
-				juce::Colour colourBackground, colourGraph, colourPrimary, colourSecondary, colourTracker;
+				juce::Colour colourBackground, colourGraph, colourPrimary, colourSecondary, colourTracker, colourLow, colourMid, colourHigh;
 
 				EnvelopeModes envelopeMode;
 				SubSampleInterpolation sampleInterpolation;
@@ -255,6 +335,10 @@
 			std::pair<std::atomic<float>, std::atomic<float>> threadedMousePos;
 			cpl::aligned_vector<std::complex<double>, 32> transformBuffer;
 			cpl::aligned_vector<double, 16> temporaryBuffer;
+			/// <summary>
+			/// Mixed channels for the trigger preprocessors, only grows.
+			/// </summary>
+			cpl::aligned_vector<AFloat, 32> mixedSignal;
 			const SharedBehaviour & globalBehaviour;
 
 			struct BinRecord
@@ -297,6 +381,10 @@
 				/// The sample offset for the detected fundamental at T = 0 - state.effectiveWindowSize
 				/// </summary>
 				double sampleOffset;
+				/// <summary>
+				/// The amount of samples the latest pitch analysis covered
+				/// </summary>
+				std::size_t analysisSize = OscilloscopeContent::LookaheadSize;
 			} triggerState;
 
 
@@ -311,8 +399,122 @@
 			std::size_t medianPos;
 			std::array<MedianData, MedianData::FilterSize> medianTriggerFilter;
 
+			/// <summary>
+			/// Results of the spectral pitch estimation, written by the audio thread.
+			/// Protected by bufferLock.
+			/// </summary>
+			struct PitchAnalysis
+			{
+				static constexpr std::size_t MinimumSize = 2048;
+				static constexpr std::size_t PeriodsPerAnalysis = 16;
+
+				/// <summary>
+				/// Target sample rate of the YIN lag search
+				/// </summary>
+				static constexpr double DecimatedRate = 11025;
+				/// <summary>
+				/// Lowest fundamental the YIN estimation searches for, as long as it fits inside the lookahead
+				/// </summary>
+				static constexpr double MinimumFrequency = 30;
+				static constexpr AFloat YinThreshold = 0.15f;
+				static constexpr AFloat UnvoicedThreshold = 0.5f;
+
+				/// <summary>
+				/// The latest median-filtered estimate, with bins relative to OscilloscopeContent::LookaheadSize
+				/// </summary>
+				BinRecord record{};
+				/// <summary>
+				/// The amount of samples the next analysis is computed over. Power of two, adapted to the detected period.
+				/// </summary>
+				std::size_t size = OscilloscopeContent::LookaheadSize;
+				std::size_t pendingSamples = 0;
+				/// <summary>
+				/// The triggering mode the size and median history were produced by. The spectral and time-domain
+				/// estimations size their analyses differently, so neither can be reused by the other.
+				/// </summary>
+				OscilloscopeContent::TriggeringMode mode = OscilloscopeContent::TriggeringMode::Spectral;
+				/// <summary>
+				/// exp(-i * tau * k / OscilloscopeContent::LookaheadSize) for the first half of the unit circle.
+				/// </summary>
+				cpl::aligned_vector<std::complex<double>, 32> twiddles;
+				/// <summary>
+				/// Full rate, decimated and difference function buffers for the YIN estimation
+				/// </summary>
+				cpl::aligned_vector<AFloat, 32> signal, decimated, difference;
+			} pitchAnalysis;
+
+			/// <summary>
+			/// Decaying hit counts of the drawn waveforms for the persistence display, one per view.
+			/// Stored row major, like the image. Only touched by the rendering thread.
+			/// </summary>
+			struct Persistence
+			{
+				static const std::size_t Views = 2;
+
+				std::size_t width = 0, height = 0;
+				std::array<cpl::aligned_vector<AFloat, 32>, Views> hits;
+				std::array<ChannelData::PixelType, Views> keys;
+				std::array<bool, Views> used{};
+				/// <summary>
+				/// The renderDataVersion last rasterized into each view, so a window is only added once
+				/// </summary>
+				std::array<std::uint64_t, Views> versions{ { std::uint64_t(-1), std::uint64_t(-1) } };
+				/// <summary>
+				/// Triggered windows published as of the last snapshot, and since the one before
+				/// </summary>
+				std::uint64_t seenWindows = 0, newWindows = 0;
+				/// <summary>
+				/// The most windows added to a view this frame, and its average over frames
+				/// </summary>
+				AFloat frameWindows = 0;
+				double windowsPerFrame = 1;
+				PhosphorImage image;
+			} persistence;
+
+			/// <summary>
+			/// Preallocated vertex arrays for drawWavePlot(), only grown. Only touched by the rendering thread.
+			/// </summary>
+			struct VertexBuffer
+			{
+				cpl::aligned_vector<GLfloat, 32> vertices;
+				std::vector<ChannelData::PixelType> colours;
+			} vertexBuffer;
+
+			/// <summary>
+			/// Widened line strips of the vertexBuffer, streamed to the line shader. Only touched by the rendering thread.
+			/// </summary>
+			LineGeometry lineGeometry;
+			LineStream lineStream;
+			/// <summary>
+			/// The part of the view the current channel is drawn into, for the line shader
+			/// </summary>
+			LineTransform splitView = LineTransform::identity();
+
 			cpl::CMutex::Lockable bufferLock;
 			ChannelData channelData;
+			/// <summary>
+			/// Copy of the read window of channelData, captured under bufferLock once per frame (if it changed).
+			/// Only touched by the rendering thread, which draws from it without holding the lock.
+			/// </summary>
+			ChannelData renderData;
+			std::uint64_t renderDataVersion = -1;
+
+			/// <summary>
+			/// Long history for scrolling back, if enabled. Fed by the audio thread, requested and read by the renderer.
+			/// </summary>
+			DiskCapture capture;
+
+			/// <summary>
+			/// What the renderer last read from the capture: the page summaries, and the displayed window relative to them.
+			/// The window ends at the absolute position end, set when the scrollback changes.
+			/// </summary>
+			struct CaptureView
+			{
+				std::vector<DiskCapture::PageSummary> pages;
+				std::uint64_t framesAgo = 0, end = 0;
+				std::size_t window = 0;
+				double scrollback = -1;
+			} captureView;
 
 			class DefaultKey;
 
@@ -323,8 +525,48 @@
 				typedef ChannelData::AudioBuffer::ProxyView::const_iterator AudioIt;
 				typedef ChannelData::ColourBuffer::ProxyView::const_iterator ColourIt;
 				typedef ChannelData::AudioBuffer::ProxyView::value_type AudioT;
-				typedef ChannelData::ColourBuffer::ProxyView::value_type ColourT;
+				typedef ChannelData::PixelType ColourT;
+
+				/// <summary>
+				/// A range of a circular buffer, as two contiguous parts. The second part is empty unless the range wraps around.
+				/// </summary>
+				template<typename It>
+				struct RingSpan
+				{
+					It first {}, second {};
+					std::size_t firstSize = 0, secondSize = 0;
+
+					std::size_t size() const noexcept { return firstSize + secondSize; }
+				};
+
+				/// <summary>
+				/// Returns count elements of the view, starting offset elements from its cursor.
+				/// The count is capped to the size of the view.
+				/// </summary>
+				template<typename View>
+				static RingSpan<typename View::const_iterator> spanOf(const View & view, cpl::ssize_t offset, std::size_t count) noexcept
+				{
+					RingSpan<typename View::const_iterator> ret;
 
+					const auto size = static_cast<cpl::ssize_t>(view.size());
+
+					if (size == 0)
+						return ret;
+
+					count = std::min<std::size_t>(count, size);
+
+					auto position = (static_cast<cpl::ssize_t>(view.cursorPosition()) + offset) % size;
+
+					if (position < 0)
+						position += size;
+
+					ret.first = view.begin() + position;
+					ret.firstSize = std::min<std::size_t>(count, size - position);
+					ret.second = view.begin();
+					ret.secondSize = count - ret.firstSize;
+
+					return ret;
+				}
 			};
 
 			template<OscChannels channelConfiguration, std::size_t ColourIndice>
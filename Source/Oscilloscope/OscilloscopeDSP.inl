@@ -34,6 +34,7 @@
 #include <cpl/CMutex.h>
 #include <cpl/Mathext.h>
 #include <cpl/simd.h>
+#include <numeric>
 
 namespace Signalizer
 {
@@ -41,14 +42,11 @@ namespace Signalizer
 	template<typename ISA, typename Eval>
 	void Oscilloscope::analyseAndSetupState()
 	{
-		calculateFundamentalPeriod<ISA, Eval>();
 		calculateTriggeringOffset<ISA, Eval>();
 
-		resizeAudioStorage();
-
 		if (state.envelopeMode == EnvelopeModes::PeakDecay)
 		{
-			runPeakFilter<ISA>();
+			runPeakFilter();
 		}
 		else if (state.envelopeMode == EnvelopeModes::None)
 		{
@@ -56,14 +54,11 @@ namespace Signalizer
 		}
 	}
 
-	template<typename ISA, typename Eval>
-	void Oscilloscope::calculateFundamentalPeriod()
+	inline void Oscilloscope::calculateFundamentalPeriod()
 	{
-#ifdef PHASE_VOCODER
-		auto const TransformSize = OscilloscopeContent::LookaheadSize >> 1;
-#else
 		auto const TransformSize = OscilloscopeContent::LookaheadSize;
-#endif
+
+		triggerState.analysisSize = pitchAnalysis.size;
 
 		if (state.customTrigger)
 		{
@@ -75,148 +70,416 @@ namespace Signalizer
 			triggerState.fundamental = state.customTriggerFrequency;
 			triggerState.cycleSamples = audioStream.getAudioHistorySamplerate() / fundamental;
 		}
-		else if(state.triggerMode == OscilloscopeContent::TriggeringMode::Spectral)
+		else if(OscilloscopeContent::isPitchTracking(state.triggerMode))
+		{
+			// estimated on the audio thread, see runPitchAnalysis()
+			auto const & max = pitchAnalysis.record;
+
+			triggerState.record = max;
+
+			auto fundamental = audioStream.getAudioHistorySamplerate() * (max.omega()) / TransformSize;
+
+			triggerState.fundamental = fundamental = std::max(5.0, fundamental);
+			triggerState.cycleSamples = audioStream.getAudioHistorySamplerate() / fundamental;
+		}
+	}
+
+	template<typename ISA>
+	void Oscilloscope::runPitchAnalysis(std::size_t numSamples)
+	{
+		if (!OscilloscopeContent::isPitchTracking(state.triggerMode) || state.customTrigger)
 		{
-			Eval eval(channelData);
+			pitchAnalysis.pendingSamples = 0;
+			return;
+		}
 
-			if (!eval.isWellDefined())
+		pitchAnalysis.pendingSamples += numSamples;
+
+		// analyse with 75% overlap, independent of the frame rate
+		if (pitchAnalysis.pendingSamples < (pitchAnalysis.size >> 2))
+			return;
+
+		pitchAnalysis.pendingSamples = 0;
+
+		auto mode = state.channelMode;
+
+		if (channelData.front.channels.size() < 2)
+			mode = OscChannels::Left;
+
+		// same evaluators as used for analysis by the renderer
+		switch (mode)
+		{
+		default: case OscChannels::Left: case OscChannels::Separate:
+			estimatePitch<ISA, SampleColourEvaluator<OscChannels::Left, 0>>();
+			break;
+		case OscChannels::Right:
+			estimatePitch<ISA, SampleColourEvaluator<OscChannels::Right, 0>>();
+			break;
+		case OscChannels::Mid: case OscChannels::MidSide:
+			estimatePitch<ISA, SampleColourEvaluator<OscChannels::Mid, 0>>();
+			break;
+		case OscChannels::Side:
+			estimatePitch<ISA, SampleColourEvaluator<OscChannels::Side, 0>>();
+			break;
+		}
+	}
+
+	template<typename ISA, typename Eval>
+	void Oscilloscope::estimatePitch()
+	{
+		if (pitchAnalysis.mode != state.triggerMode)
+		{
+			// the spectral estimation needs a power of two size, and the median history is relative to the old sizes
+			pitchAnalysis.mode = state.triggerMode;
+			pitchAnalysis.size = OscilloscopeContent::LookaheadSize;
+			pitchAnalysis.record = BinRecord{};
+			medianTriggerFilter.fill(MedianData{});
+			medianPos = 0;
+		}
+
+		if (state.triggerMode == OscilloscopeContent::TriggeringMode::Pitch)
+			estimatePeriod<ISA, Eval>();
+		else
+			estimateFundamental<ISA, Eval>();
+	}
+
+	/// <summary>
+	/// Sum of squared differences between a and b. a must be aligned.
+	/// </summary>
+	template<typename ISA>
+	inline AFloat squaredDifference(const AFloat * a, const AFloat * b, std::size_t size) noexcept
+	{
+		using namespace cpl::simd;
+		typedef typename ISA::V V;
+
+		auto const lanes = elements_of<V>::value;
+		auto const stop = size - (size & (lanes - 1));
+
+		V vSum = zero<V>();
+
+		for (std::size_t i = 0; i < stop; i += lanes)
+		{
+			auto const vDelta = load<V>(a + i) - loadu<V>(b + i);
+			vSum += vDelta * vDelta;
+		}
+
+		suitable_container<V> sums = vSum;
+		AFloat sum = std::accumulate(sums.begin(), sums.end(), AFloat(0));
+
+		for (std::size_t i = stop; i < size; ++i)
+		{
+			auto const delta = a[i] - b[i];
+			sum += delta * delta;
+		}
+
+		return sum;
+	}
+
+	template<typename ISA, typename Eval>
+	void Oscilloscope::estimatePeriod()
+	{
+		Eval eval(channelData);
+
+		auto const sampleRate = audioStream.getAudioHistorySamplerate();
+
+		if (!eval.isWellDefined() || sampleRate <= 0)
+			return;
+
+		// the lag search runs on a decimated signal, that is refined at full rate around the result afterwards
+		auto const factor = std::max<std::size_t>(1, static_cast<std::size_t>(sampleRate / PitchAnalysis::DecimatedRate));
+		// the integration window equals the longest lag, and everything has to fit inside the lookahead
+		auto const lagLimit = ((OscilloscopeContent::LookaheadSize / factor) - 2) / 2;
+		auto const maxLag = std::min<std::size_t>(lagLimit, static_cast<std::size_t>(std::ceil(sampleRate / (factor * PitchAnalysis::MinimumFrequency))));
+		auto const window = maxLag;
+		auto const decimatedSize = window + maxLag + 2;
+		auto const size = decimatedSize * factor;
+
+		if (maxLag < 4)
+			return;
+
+		auto & signal = pitchAnalysis.signal;
+		auto & decimated = pitchAnalysis.decimated;
+		auto & difference = pitchAnalysis.difference;
+
+		// only grows when the sample rate does
+		if (signal.size() < size)
+			signal.resize(size);
+		if (decimated.size() < decimatedSize)
+			decimated.resize(decimatedSize);
+		if (difference.size() < maxLag + 1)
+			difference.resize(maxLag + 1);
+
+		pitchAnalysis.size = size;
+
+		// we will try to analyse the points closest to the sync point (latest in time)
+		auto offset = std::max<std::size_t>(std::ceil(state.effectiveWindowSize), size);
+
+		eval.startFrom(-static_cast<cpl::ssize_t>(offset));
+
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			signal[i] = eval.evaluateSampleInc();
+		}
+
+		// boxcar decimation, crude but enough to keep strong overtones from folding onto the fundamental
+		const AFloat invFactor = AFloat(1) / factor;
+
+		for (std::size_t i = 0; i < decimatedSize; ++i)
+		{
+			auto const begin = signal.data() + i * factor;
+			decimated[i] = invFactor * std::accumulate(begin, begin + factor, AFloat(0));
+		}
+
+		// cumulative mean normalized difference function
+		difference[0] = 1;
+		double runningSum = 0;
+
+		for (std::size_t lag = 1; lag <= maxLag; ++lag)
+		{
+			auto const d = squaredDifference<ISA>(decimated.data(), decimated.data() + lag, window);
+			runningSum += d;
+			difference[lag] = runningSum > 0 ? static_cast<AFloat>(d * lag / runningSum) : AFloat(1);
+		}
+
+		// first dip under the threshold, followed to its minimum
+		std::size_t lag = 0;
+
+		for (std::size_t i = 2; i <= maxLag; ++i)
+		{
+			if (difference[i] < PitchAnalysis::YinThreshold)
+			{
+				lag = i;
+				while (lag + 1 <= maxLag && difference[lag + 1] < difference[lag])
+					lag++;
+				break;
+			}
+		}
+
+		if (lag == 0)
+		{
+			lag = std::distance(difference.begin(), std::min_element(difference.begin() + 2, difference.begin() + maxLag + 1));
+
+			// unvoiced or noise; keep the previous estimate
+			if (difference[lag] > PitchAnalysis::UnvoicedThreshold)
 				return;
+		}
+
+		// refine at full rate around the decimated result
+		auto const fullWindow = window * factor;
+		auto const lowestLag = std::max<std::size_t>(1, (lag - 1) * factor);
+		auto const highestLag = std::min(size - fullWindow - 1, (lag + 1) * factor);
 
-			// we will try to analyse the points closest to the sync point (latest in time)
-			auto offset = std::max<std::size_t>(std::ceil(state.effectiveWindowSize), OscilloscopeContent::LookaheadSize);
+		auto fullRate = [&](std::size_t l) { return squaredDifference<ISA>(signal.data(), signal.data() + l, fullWindow); };
 
-			eval.startFrom(-static_cast<cpl::ssize_t>(offset));
+		std::size_t bestLag = lowestLag;
+		AFloat best = fullRate(lowestLag);
 
-			for (std::size_t i = 0; i < OscilloscopeContent::LookaheadSize; ++i)
+		for (std::size_t l = lowestLag + 1; l <= highestLag; ++l)
+		{
+			auto const current = fullRate(l);
+			if (current < best)
 			{
-				transformBuffer[i] = eval.evaluateSampleInc();
+				best = current;
+				bestLag = l;
 			}
+		}
+
+		double period = bestLag;
+
+		// parabolic interpolation of the minimum
+		if (bestLag > 1 && bestLag + 1 < size - fullWindow)
+		{
+			auto const prev = fullRate(bestLag - 1), next = fullRate(bestLag + 1);
+			auto const denom = prev - 2 * best + next;
+
+			if (denom > 0)
+				period += 0.5 * (prev - next) / denom;
+		}
 
+		// publish in the same bins as the spectral estimation, relative to the full lookahead
+		auto const omega = OscilloscopeContent::LookaheadSize / period;
+		BinRecord record{ static_cast<std::size_t>(omega), 1 - difference[lag] };
+		record.offset = omega - record.index;
 
-			signaldust::DustFFT_fwdDa(reinterpret_cast<double*>(transformBuffer.data()), TransformSize);
-#ifdef PHASE_VOCODER
-			signaldust::DustFFT_fwdDa(reinterpret_cast<double*>(transformBuffer.data() + TransformSize), TransformSize);
-#endif
-			// estimates the true frequency by calculating a bin offset to the current bin w
-			auto quadDelta = [&](auto w) {
-#if PHASE_VOCODER
-				auto deltaBinOffset = std::arg(transformBuffer[w]) - std::arg(transformBuffer[TransformSize + w]);
+		publishFundamental(record);
+	}
 
-				deltaBinOffset -= w * 2 * M_PI;
+	template<typename ISA, typename Eval>
+	void Oscilloscope::estimateFundamental()
+	{
+		Eval eval(channelData);
 
-				while (deltaBinOffset < 2 * M_PI)
-					deltaBinOffset += 2 * M_PI;
+		if (!eval.isWellDefined())
+			return;
 
-				while (deltaBinOffset > 2 * M_PI)
-					deltaBinOffset -= 2 * M_PI;
+		auto const TransformSize = pitchAnalysis.size;
+		auto const halfSize = TransformSize >> 1;
 
-				return deltaBinOffset / (2 * M_PI);
-#else
-				const auto
-					x0 = transformBuffer[w],
-					x1 = transformBuffer[w + 1],
-					xm1 = transformBuffer[w == 0 ? 1 : w - 1];
+		// we will try to analyse the points closest to the sync point (latest in time)
+		auto offset = std::max<std::size_t>(std::ceil(state.effectiveWindowSize), TransformSize);
 
-				const auto denom = x0 * 2.0 - xm1 - x1;
+		eval.startFrom(-static_cast<cpl::ssize_t>(offset));
 
-				return (denom.real() + denom.imag()) != 0 ? std::real((xm1 - x1) / denom) : 0;
-#endif
-			};
+		// pack the real signal into a half-sized complex transform: even samples real, odd samples imaginary
+		for (std::size_t i = 0; i < halfSize; ++i)
+		{
+			auto const even = eval.evaluateSampleInc();
+			auto const odd = eval.evaluateSampleInc();
+			transformBuffer[i] = { even, odd };
+		}
 
-			const double quarterSemitone = std::pow(2, 0.25 / 12.0) - 1;
-			const double threshold = content->triggerThreshold.getTransformedValue();
-			const double hysteresis = content->triggerHysteresis.getTransformedValue();
-			const auto invHysteresis = 1 - hysteresis;
+		signaldust::DustFFT_fwdDa(reinterpret_cast<double*>(transformBuffer.data()), static_cast<unsigned int>(halfSize));
 
-			BinRecord max{ 1, std::max(threshold * TransformSize, std::abs(transformBuffer[1])), quadDelta(1) };
+		// unpack the spectrum of the real signal in place, bins [0, halfSize]
+		{
+			auto const z0 = transformBuffer[0];
+			transformBuffer[0] = z0.real() + z0.imag();
+			transformBuffer[halfSize] = z0.real() - z0.imag();
 
-			for (std::size_t i = 2; i < (TransformSize >> 1); ++i)
+			auto const stride = OscilloscopeContent::LookaheadSize / TransformSize;
+			const std::complex<double> halfI(0, 0.5);
+
+			auto unpack = [&](auto a, auto b, auto k)
 			{
-				BinRecord current{ i, std::abs(transformBuffer[i]) };
+				auto const c = std::conj(b);
+				return 0.5 * (a + c) - halfI * pitchAnalysis.twiddles[k * stride] * (a - c);
+			};
 
-				// candidate must be vastly better
-				if (invHysteresis * current.value > max.value * 2)
-				{
-					// weird parabolas
-					if (max.omega() > 0)
-					{
-						// check if it is somewhat harmonically related, in which case we discard the candidate
-						current.offset = quadDelta(i);
+			for (std::size_t k = 1; k <= (halfSize >> 1); ++k)
+			{
+				auto const j = halfSize - k;
+				auto const zk = transformBuffer[k], zj = transformBuffer[j];
+
+				transformBuffer[k] = unpack(zk, zj, k);
+				transformBuffer[j] = unpack(zj, zk, j);
+			}
+		}
 
-						// harmonic relationship
-						auto factor = current.omega() / max.omega();
+		// estimates the true frequency by calculating a bin offset to the current bin w
+		auto quadDelta = [&](auto w) {
+			const auto
+				x0 = transformBuffer[w],
+				x1 = transformBuffer[w + 1],
+				xm1 = transformBuffer[w == 0 ? 1 : w - 1];
 
-						auto sensivity = current.value / max.value;
+			const auto denom = x0 * 2.0 - xm1 - x1;
 
-						// shortcut if the value is 20 times bigger
-						if (invHysteresis * sensivity > 20)
-						{
-							max = current;
-							continue;
-						}
+			return (denom.real() + denom.imag()) != 0 ? std::real((xm1 - x1) / denom) : 0;
+		};
 
-						// the same value, just a better estimate, from another bin
-						// TODO: fix this case by polynomially interpolate the value as well
-						if (std::abs(1 - factor) < invHysteresis * quarterSemitone)
-						{
-							max = current;
-							continue;
-						}
+		const double quarterSemitone = std::pow(2, 0.25 / 12.0) - 1;
+		const double threshold = content->triggerThreshold.getTransformedValue();
+		const double hysteresis = content->triggerHysteresis.getTransformedValue();
+		const auto invHysteresis = 1 - hysteresis;
 
-						auto multipleDeviation = std::abs(factor - std::floor(factor + 0.5));
+		BinRecord max{ 1, std::max(threshold * TransformSize, std::abs(transformBuffer[1])), quadDelta(1) };
 
-						// check if the harmonic series is more than half a semi-tone away, in which case we take the candidate
-						if (invHysteresis * std::abs(multipleDeviation) > quarterSemitone)
-						{
-							max = current;
-						}
+		for (std::size_t i = 2; i < halfSize; ++i)
+		{
+			BinRecord current{ i, std::abs(transformBuffer[i]) };
+
+			// candidate must be vastly better
+			if (invHysteresis * current.value > max.value * 2)
+			{
+				// weird parabolas
+				if (max.omega() > 0)
+				{
+					// check if it is somewhat harmonically related, in which case we discard the candidate
+					current.offset = quadDelta(i);
+
+					// harmonic relationship
+					auto factor = current.omega() / max.omega();
+
+					auto sensivity = current.value / max.value;
+
+					// shortcut if the value is 20 times bigger
+					if (invHysteresis * sensivity > 20)
+					{
+						max = current;
+						continue;
 					}
-					else
+
+					// the same value, just a better estimate, from another bin
+					// TODO: fix this case by polynomially interpolate the value as well
+					if (std::abs(1 - factor) < invHysteresis * quarterSemitone)
 					{
 						max = current;
-						max.offset = quadDelta(max.index);
+						continue;
 					}
 
+					auto multipleDeviation = std::abs(factor - std::floor(factor + 0.5));
+
+					// check if the harmonic series is more than half a semi-tone away, in which case we take the candidate
+					if (invHysteresis * std::abs(multipleDeviation) > quarterSemitone)
+					{
+						max = current;
+					}
+				}
+				else
+				{
+					max = current;
+					max.offset = quadDelta(max.index);
 				}
+
 			}
+		}
 
-			// copy old filter
-			auto localMedian = medianTriggerFilter;
+		// published bins are relative to the full lookahead, regardless of the size of this analysis
+		{
+			auto const omega = max.omega() * (OscilloscopeContent::LookaheadSize / TransformSize);
+			max.index = static_cast<std::size_t>(std::max(0.0, std::floor(omega)));
+			max.offset = omega - max.index;
+		}
 
-			// store new data
-			medianTriggerFilter[medianPos].record = max;
+		publishFundamental(max);
 
-			medianPos++;
-			medianPos &= (MedianData::FilterSize - 1);
+		// the next analysis only needs to cover a couple of periods of what was detected,
+		// which lowers the latency and cost for higher pitches
+		max = pitchAnalysis.record;
 
-			const auto middle = (MedianData::FilterSize >> 1);
-			std::nth_element(
-				localMedian.begin(),
-				localMedian.begin() + middle,
-				localMedian.end(),
-				[](const auto & a, const auto & b)
-				{
-					return a.record.index < b.record.index;
-				}
-			);
+		if (max.omega() > 0)
+		{
+			auto const periodSamples = OscilloscopeContent::LookaheadSize / max.omega();
+			auto const wanted = cpl::Math::nextPow2Inc(static_cast<std::size_t>(std::ceil(PitchAnalysis::PeriodsPerAnalysis * periodSamples)));
+			pitchAnalysis.size = cpl::Math::confineTo<std::size_t>(wanted, PitchAnalysis::MinimumSize, OscilloscopeContent::LookaheadSize);
+		}
+		else
+		{
+			pitchAnalysis.size = OscilloscopeContent::LookaheadSize;
+		}
+	}
 
-			auto & oldMedianBin = localMedian[middle];
+	inline void Oscilloscope::publishFundamental(BinRecord max)
+	{
+		// copy old filter
+		auto localMedian = medianTriggerFilter;
 
-			// check to discard (temporarily) much higher frequencies through a median filter
-			if (oldMedianBin.record.index != -1 && std::abs(max.omega() - (oldMedianBin.record.omega())) > 0.5)
-			{
-				max = oldMedianBin.record;
-			}
+		// store new data
+		medianTriggerFilter[medianPos].record = max;
 
-			triggerState.record = max;
+		medianPos++;
+		medianPos &= (MedianData::FilterSize - 1);
 
-			// interpolate peak position quadratically
+		const auto middle = (MedianData::FilterSize >> 1);
+		std::nth_element(
+			localMedian.begin(),
+			localMedian.begin() + middle,
+			localMedian.end(),
+			[](const auto & a, const auto & b)
+			{
+				return a.record.index < b.record.index;
+			}
+		);
 
-			auto fundamental = audioStream.getAudioHistorySamplerate() * (max.omega()) / TransformSize;
+		auto & oldMedianBin = localMedian[middle];
 
-			triggerState.fundamental = fundamental = std::max(5.0, fundamental);
-			triggerState.cycleSamples = audioStream.getAudioHistorySamplerate() / fundamental;
+		// check to discard (temporarily) much higher frequencies through a median filter
+		if (oldMedianBin.record.index != -1 && std::abs(max.omega() - (oldMedianBin.record.omega())) > 0.5)
+		{
+			max = oldMedianBin.record;
 		}
+
+		pitchAnalysis.record = max;
 	}
 
 	inline double Oscilloscope::getGain()
@@ -235,7 +498,7 @@ namespace Signalizer
 			triggerState.sampleOffset = (state.effectiveWindowSize * 0.5 - (int)(state.effectiveWindowSize * 0.5)) - 1.5;
 			return;
 		}
-		else if (state.triggerMode != OscilloscopeContent::TriggeringMode::Spectral)
+		else if (!OscilloscopeContent::isPitchTracking(state.triggerMode))
 		{
 			triggerState.sampleOffset = 0;
 			triggerState.cycleSamples = 0;
@@ -243,13 +506,11 @@ namespace Signalizer
 			return;
 		}
 
-#ifdef PHASE_VOCODER
-		auto const TransformSize = OscilloscopeContent::LookaheadSize >> 1;
-#else
 		auto const TransformSize = OscilloscopeContent::LookaheadSize;
-#endif
+		// the phase is estimated over the same amount of samples as the latest pitch analysis
+		auto const analysisSize = triggerState.analysisSize;
 
-		Eval eval(channelData);
+		Eval eval(renderData);
 
 		if (!eval.isWellDefined())
 			return;
@@ -258,20 +519,20 @@ namespace Signalizer
 		const auto radians = tau * (triggerState.record.omega()) / TransformSize;
 
 		// we will try to analyse the points closest to the sync point (latest in time)
-		auto offsetReal = std::max<double>(OscilloscopeContent::LookaheadSize, state.effectiveWindowSize + triggerState.cycleSamples);
+		auto offsetReal = std::max<double>(analysisSize, state.effectiveWindowSize + triggerState.cycleSamples);
 		auto const offset = (std::size_t)std::ceil(offsetReal);
 
 		auto sampleDifference = offset - (state.effectiveWindowSize + triggerState.cycleSamples);
 
 		eval.startFrom(-static_cast<cpl::ssize_t>(offset));
 
-		for (std::size_t i = 0; i < OscilloscopeContent::LookaheadSize; ++i)
+		for (std::size_t i = 0; i < analysisSize; ++i)
 		{
 			temporaryBuffer[i] = eval.evaluateSampleInc();
 		}
 
 		// get the complex sinusoid phase
-		auto z = cpl::dsp::goertzel(temporaryBuffer, OscilloscopeContent::LookaheadSize, radians);
+		auto z = cpl::dsp::goertzel(temporaryBuffer, analysisSize, radians);
 
 		// rotate the sinusoid by the fractional difference in samples
 		// a basic identity of the DFT, if the time domain is moved by k,
@@ -310,7 +571,7 @@ namespace Signalizer
 		// TODO: Add
 		// std::size_t additionalSamples = state.sampleInterpolation == SubSampleInterpolation::Lanczos ? OscilloscopeContent::InterpolationKernelSize : 0;
 
-		if (state.triggerMode == OscilloscopeContent::TriggeringMode::Spectral)
+		if (OscilloscopeContent::isPitchTracking(state.triggerMode))
 		{
 			// buffer size = length of detected freq in samples + display window size + lookahead
 			requiredSampleBufferSize = std::max(static_cast<std::size_t>(0.5 + triggerState.cycleSamples + std::ceil(state.effectiveWindowSize)), OscilloscopeContent::LookaheadSize);
@@ -320,8 +581,17 @@ namespace Signalizer
 			//requiredSampleBufferSize = static_cast<std::size_t>(0.5 + triggerState.cycleSamples + std::ceil(state.effectiveWindowSize) * 2) + OscilloscopeContent::LookaheadSize;
 			requiredSampleBufferSize = static_cast<std::size_t>(std::ceil(state.effectiveWindowSize + 1));
 		}
-		channelData.front.resizeStorage(requiredSampleBufferSize, std::max(requiredSampleBufferSize, audioStream.getAudioHistoryCapacity()));
-		channelData.back.resizeStorage(requiredSampleBufferSize, std::max(requiredSampleBufferSize, audioStream.getAudioHistoryCapacity()));
+		// only allocate the colour streams the evaluators of the current mode read, see audioProcessing()
+		const auto mode = state.channelMode;
+		const bool colouring = state.colourChannelsByFrequency, mono = channelData.front.channels.size() < 2;
+
+		ChannelData::Allocation allocation;
+		allocation.channelColours = { { colouring && (mono || mode == OscChannels::Left || mode == OscChannels::Separate), colouring && (mode == OscChannels::Right || mode == OscChannels::Separate) } };
+		allocation.midSideColours = { { colouring && (mode == OscChannels::Mid || mode == OscChannels::MidSide), colouring && (mode == OscChannels::Side || mode == OscChannels::MidSide) } };
+		allocation.back = state.triggerMode == OscilloscopeContent::TriggeringMode::EnvelopeHold || state.triggerMode == OscilloscopeContent::TriggeringMode::ZeroCrossing;
+
+		// sized for the window rather than the entire audio history
+		channelData.resizeStorage(requiredSampleBufferSize, cpl::Math::nextPow2Inc(requiredSampleBufferSize), allocation);
 	}
 
 
@@ -335,51 +605,35 @@ namespace Signalizer
 		if (numChannels == 1)
 			mode = OscChannels::Left;
 
-		if (numChannels == 1)
+		const AFloat * signal = buffer[0];
+
+		switch (mode)
 		{
-			for (std::size_t n = 0; n < numSamples; ++n)
-			{
-				ana.process(buffer[0][n]);
-			}
-		}
-		else
+		case OscChannels::Right:
+			signal = buffer[1];
+			break;
+		case OscChannels::Side: case OscChannels::Mid: case OscChannels::MidSide:
 		{
-			std::size_t offset = 0;
-			switch (mode)
-			{
-			case OscChannels::Right: offset = 1;
-			case OscChannels::Left:
+			// mix the block once, instead of per sample in the analyzer
+			if (mixedSignal.size() < numSamples)
+				mixedSignal.resize(numSamples);
+
+			const AFloat sign = mode == OscChannels::Side ? -1 : 1;
+			const auto left = buffer[0], right = buffer[1];
+
+			for (std::size_t n = 0; n < numSamples; ++n)
 			{
-				const auto channel = buffer[offset];
-				for (std::size_t n = 0; n < numSamples; ++n)
-				{
-					ana.process(channel[n]);
-				}
-				break;
+				mixedSignal[n] = static_cast<AFloat>(0.5) * (left[n] + sign * right[n]);
 			}
-			case OscChannels::Side:
-				for (std::size_t n = 0; n < numSamples; ++n)
-				{
-					ana.process(0.5 * (buffer[0][n] - buffer[1][n]));
-				}
-				break;
-			case OscChannels::Separate:
-				for (std::size_t n = 0; n < numSamples; ++n)
-				{
-					ana.process(buffer[0][n]);
-				}
 
-				break;
-			case OscChannels::Mid: case OscChannels::MidSide:
-				for (std::size_t n = 0; n < numSamples; ++n)
-				{
-					ana.process(0.5 * (buffer[0][n] + buffer[1][n]));
-				}
-				break;
-			}
+			signal = mixedSignal.data();
+			break;
+		}
+		default:
+			break;
 		}
 
-
+		ana.processBlock(signal, numSamples);
 	}
 
 	template<typename ISA>
@@ -416,7 +670,9 @@ namespace Signalizer
 
 		if (state.triggerMode != OscilloscopeContent::TriggeringMode::EnvelopeHold && state.triggerMode != OscilloscopeContent::TriggeringMode::ZeroCrossing)
 		{
+			channelData.publishFront();
 			audioProcessing<ISA>(localBuffers, numChannels, numSamples, channelData.front);
+			runPitchAnalysis<ISA>(numSamples);
 		}
 		else
 		{
@@ -439,6 +695,9 @@ namespace Signalizer
 			channelData.tuneColourSmoothing(content->colourSmoothing.getTransformedValue(), sampleRate);
 			channelData.tuneCrossOver(300, 3000, sampleRate);
 
+			// colour streams are only read when colouring by frequency
+			const bool colouring = content->channelColouring.param.getAsTEnum<OscilloscopeContent::ColourMode>() == OscilloscopeContent::ColourMode::SpectralEnergy;
+
 
 			if (target.channels[0].audioData.getSize() < 1)
 				return;
@@ -449,11 +708,6 @@ namespace Signalizer
 			const auto envelopeCoeff = std::exp(-1.0 / (content->envelopeWindow.getNormalizedValue() * audioStream.getAudioHistorySamplerate()));
 			T filterEnv[2] = { filters.envelope[0], filters.envelope[1] };
 
-			auto colourArray = [](const auto & colourParam)
-			{
-				return std::array<float, 3> {static_cast<AFloat>(colourParam.r.getValue()), static_cast<AFloat>(colourParam.g.getValue()), static_cast<AFloat>(colourParam.b.getValue())};
-			};
-
 			auto filterStates = [=](const auto & bands, auto & states)
 			{
 				for (std::size_t i = 0; i < ChannelData::Bands; ++i)
@@ -464,47 +718,43 @@ namespace Signalizer
 
 			};
 
-			decltype(colourArray(content->lowColour)) colours[] = { colourArray(content->lowColour), colourArray(content->midColour), colourArray(content->highColour) };
-
-			auto accumulateColour = [&colours](const auto & state, ChannelData::PixelType key, float blend)
-			{
-				typedef ChannelData::PixelType::ComponentType C;
-				ChannelData::PixelType ret;
-				constexpr auto PixelMax = static_cast<AFloat>(std::numeric_limits<C>::max());
-				AFloat red(0), green(0), blue(0);
+			using fs = FilterStates;
 
-				for (std::size_t i = 0; i < ChannelData::Bands; ++i)
-				{
-					red += state[i] * colours[i][0];
-					green += state[i] * colours[i][1];
-					blue += state[i] * colours[i][2];
-				}
+			auto mode = content->channelConfiguration.param.getAsTEnum<OscChannels>();
 
-				auto invMax = PixelMax / std::max(red, std::max(blue, green));
+			if (numChannels == 1)
+				mode = OscChannels::Left;
 
-				ret.pixel.a = std::numeric_limits<C>::max();
-				ret.pixel.r = static_cast<C>(red * invMax);
-				ret.pixel.g = static_cast<C>(green * invMax);
-				ret.pixel.b = static_cast<C>(blue * invMax);
+			auto splitBands = [&](const AFloat * input, ChannelData::Crossover & network, std::vector<ChannelData::Crossover::BandArray> & bands)
+			{
+				if (bands.size() < numSamples)
+					bands.resize(numSamples);
 
-				return ret.lerp(key, blend);
+				for (std::size_t n = 0; n < numSamples; ++n)
+					bands[n] = network.process(input[n], channelData.networkCoeffs);
 			};
 
-			using fs = FilterStates;
+			// the band energies are stored, the colours are mixed from them when drawn
+			auto colourStream = [&](auto && bandsAt, ChannelData::Crossover::BandArray & smoothState, ChannelData::ColourBuffer & colours)
+			{
+				// not allocated yet, if the mode just changed
+				if (colours.getSize() == 0)
+					return;
 
-			auto mode = content->channelConfiguration.param.getAsTEnum<OscChannels>();
+				auto localState = smoothState;
+				auto && writer = colours.createWriter();
 
-			if (numChannels == 1)
-				mode = OscChannels::Left;
+				for (std::size_t n = 0; n < numSamples; ++n)
+				{
+					filterStates(bandsAt(n), localState);
+					writer.setHeadAndAdvance(ChannelData::encodeColour(localState));
+				}
 
-			const auto blend = 1 - content->frequencyColouringBlend.parameter.getValue();
+				smoothState = localState;
+			};
 
 			if (numChannels >= 2)
 			{
-				ChannelData::PixelType
-					firstColour(content->primaryColour.getAsJuceColour()),
-					secondColour(content->secondaryColour.getAsJuceColour());
-
 				auto sideSignal = [](const auto & left, const auto & right)
 				{
 					unq_typeof(left) ret;
@@ -521,18 +771,6 @@ namespace Signalizer
 					return ret;
 				};
 
-				auto
-					leftSmoothState = channelData.filterStates.channels[fs::Left].smoothFilters,
-					rightSmoothState = channelData.filterStates.channels[fs::Right].smoothFilters,
-					midSmoothState = channelData.filterStates.midSideSmoothsFilters[0],
-					sideSmoothState = channelData.filterStates.midSideSmoothsFilters[1];
-
-				auto &&
-					lw = target.channels[fs::Left].colourData.createWriter(),
-					rw = target.channels[fs::Right].colourData.createWriter(),
-					mw = target.midSideColour[0].createWriter(),
-					sw = target.midSideColour[1].createWriter();
-
 				std::size_t offset = 0;
 
 				// process envelopes so we're not thrashing the icache
@@ -604,46 +842,39 @@ namespace Signalizer
 
 				}
 
-				for (std::size_t n = 0; n < numSamples; ++n)
+				if (colouring)
 				{
-
-					auto & lN = channelData.filterStates.channels[fs::Left].network;
-					auto & rN = channelData.filterStates.channels[fs::Right].network;
-
-					const auto left = buffer[fs::Left][n], right = buffer[fs::Right][n];
-
-					// split signal into bands:
-					auto leftBands = rN.process(left, channelData.networkCoeffs);
-					auto rightBands = lN.process(right, channelData.networkCoeffs);
-
-					filterStates(leftBands, leftSmoothState);
-					filterStates(rightBands, rightSmoothState);
+					// the colour streams the evaluators of the current mode will read
+					const bool
+						needsMidSide = mode == OscChannels::Mid || mode == OscChannels::Side || mode == OscChannels::MidSide,
+						needsLeft = needsMidSide || mode == OscChannels::Left || mode == OscChannels::Separate,
+						needsRight = needsMidSide || mode == OscChannels::Right || mode == OscChannels::Separate;
+
+					// split the block into bands per channel first, then derive the colour streams from them
+					if (needsLeft)
+						splitBands(buffer[fs::Left], channelData.filterStates.channels[fs::Left].network, channelData.bands[fs::Left]);
+					if (needsRight)
+						splitBands(buffer[fs::Right], channelData.filterStates.channels[fs::Right].network, channelData.bands[fs::Right]);
+
+					const auto & leftBands = channelData.bands[fs::Left];
+					const auto & rightBands = channelData.bands[fs::Right];
+
+					if (mode == OscChannels::Left || mode == OscChannels::Separate)
+						colourStream([&](auto n) { return leftBands[n]; }, channelData.filterStates.channels[fs::Left].smoothFilters, target.channels[fs::Left].colourData);
+					if (mode == OscChannels::Right || mode == OscChannels::Separate)
+						colourStream([&](auto n) { return rightBands[n]; }, channelData.filterStates.channels[fs::Right].smoothFilters, target.channels[fs::Right].colourData);
 
 					// magnitude doesn't matter for these, as we normalize the data anyway -
-					filterStates(midSignal(leftBands, rightBands), midSmoothState);
-					filterStates(sideSignal(leftBands, rightBands), sideSmoothState);
-
-					lw.setHeadAndAdvance(accumulateColour(leftSmoothState, firstColour, blend));
-					rw.setHeadAndAdvance(accumulateColour(rightSmoothState, secondColour, blend));
-					mw.setHeadAndAdvance(accumulateColour(midSmoothState, firstColour, blend));
-					sw.setHeadAndAdvance(accumulateColour(sideSmoothState, secondColour, blend));
-
+					if (mode == OscChannels::Mid || mode == OscChannels::MidSide)
+						colourStream([&](auto n) { return midSignal(leftBands[n], rightBands[n]); }, channelData.filterStates.midSideSmoothsFilters[0], target.midSideColour[0]);
+					if (mode == OscChannels::Side || mode == OscChannels::MidSide)
+						colourStream([&](auto n) { return sideSignal(leftBands[n], rightBands[n]); }, channelData.filterStates.midSideSmoothsFilters[1], target.midSideColour[1]);
 				}
 
-				channelData.filterStates.channels[fs::Left].smoothFilters = leftSmoothState;
-				channelData.filterStates.channels[fs::Right].smoothFilters = rightSmoothState;
-				channelData.filterStates.midSideSmoothsFilters[0] = midSmoothState;
-				channelData.filterStates.midSideSmoothsFilters[1] = sideSmoothState;
-
 			}
 			else if (numChannels == 1)
 			{
-				ChannelData::PixelType
-					firstColour(content->primaryColour.getAsJuceColour());
-
 				filterEnv[1] = 0;
-				auto && lw = target.channels[fs::Left].colourData.createWriter();
-				auto leftSmoothState = channelData.filterStates.channels[fs::Left].smoothFilters;
 
 				for (std::size_t n = 0; n < numSamples; n++)
 				{
@@ -652,17 +883,16 @@ namespace Signalizer
 
 					// average envelope
 					filterEnv[fs::Left] = lSquared + envelopeCoeff * (filterEnv[fs::Left] - lSquared);
-					// get peak sample
+				}
 
-					// split signal into bands:
-					auto leftBands = channelData.filterStates.channels[fs::Left].network.process(left, channelData.networkCoeffs);
+				if (colouring)
+				{
+					splitBands(buffer[fs::Left], channelData.filterStates.channels[fs::Left].network, channelData.bands[fs::Left]);
 
-					filterStates(leftBands, leftSmoothState);
-					lw.setHeadAndAdvance(accumulateColour(leftSmoothState, firstColour, blend));
+					const auto & leftBands = channelData.bands[fs::Left];
+					colourStream([&](auto n) { return leftBands[n]; }, channelData.filterStates.channels[fs::Left].smoothFilters, target.channels[fs::Left].colourData);
 				}
 
-				channelData.filterStates.channels[fs::Left].smoothFilters = leftSmoothState;
-
 			}
 			// store calculated envelope
 			if (state.envelopeMode == EnvelopeModes::RMS)
@@ -682,171 +912,100 @@ namespace Signalizer
 			for(std::size_t c = 0; c < target.channels.size(); ++c)
 				target.channels[c].audioData.createWriter().copyIntoHead(buffer[c], numSamples);
 
-			state.transportPosition = audioStream.getASyncPlayhead().getPositionInSamples() + numSamples;
-
-		}
-
-	template<typename ISA>
-		void Oscilloscope::runPeakFilter()
-		{
-			// there is a number of optimisations we can do here, mostly that we actually don't care about
-			// timing, we are only interested in the current largest value in the set.
-			using namespace cpl;
-			using namespace cpl::simd;
-			using cpl::simd::load;
-
-			typedef typename ISA::V V;
-
-			V
-				vLMax = zero<V>(),
-				vRMax = zero<V>(),
-				vSign = consts<V>::sign_mask;
-
-			auto const loopIncrement = elements_of<V>::value;
-
-			auto const vHalf = consts<V>::half;
-
-			if (state.channelMode <= OscChannels::OffsetForMono)
-			{
-				auto && view = channelData.front.channels[0].audioData.createProxyView();
-
-				std::size_t numSamples = view.size();
-
-				const auto * leftBuffer = view.begin();
+			target.written += numSamples;
 
-				auto stop = numSamples - (numSamples & (loopIncrement - 1));
-				if (stop <= 0)
-					stop = 0;
+			capture.append(buffer, numChannels, target, numSamples);
 
-				// since this runs in every frame, we need to scale the coefficient by how often this function runs
-				// (and the amount of samples)
-				double power = numSamples * (avgFps.getAverage() / juce::Time::getHighResolutionTicksPerSecond());
-				double coeff = std::pow(std::exp(-static_cast<double>(loopIncrement) / (content->envelopeWindow.getNormalizedValue() * audioStream.getAudioHistorySamplerate())), power);
+			// the back buffer only reaches the display through publishBack(), which updates the front envelopes
+			if (&target == &channelData.front)
+				target.appendEnvelopes(numSamples);
 
-				if (state.channelMode == OscChannels::Left)
-				{
-					for (std::size_t i = 0; i < stop; i += loopIncrement)
-					{
-						auto const vLInput = load<V>(leftBuffer + i);
-						vLMax = max(vand(vLInput, vSign), vLMax);
-					}
-				}
-				else
-				{
-					if (channelData.front.channels.size() < 2)
-					{
-						shared.autoGainEnvelope.store(1, std::memory_order_release);
-						return;
-					}
-
-					auto && rightView = channelData.front.channels[1].audioData.createProxyView();
-					const auto * rightBuffer = rightView.begin();
-
-					switch (state.channelMode)
-					{
-					case OscChannels::Right:
-
-						for (std::size_t i = 0; i < stop; i += loopIncrement)
-						{
-							auto const vLInput = load<V>(rightBuffer + i);
-							vLMax = max(vand(vLInput, vSign), vLMax);
-						}
-						break;
-					case OscChannels::Mid:
-						for (std::size_t i = 0; i < stop; i += loopIncrement)
-						{
-							auto const vInput = load<V>(leftBuffer + i) + load<V>(rightBuffer + i);
-							vLMax = max(vand(vInput * vHalf, vSign), vLMax);
-						}
-						break;
-					case OscChannels::Side:
+			state.transportPosition = audioStream.getASyncPlayhead().getPositionInSamples() + numSamples;
 
-						for (std::size_t i = 0; i < stop; i += loopIncrement)
-						{
-							auto const vInput = load<V>(leftBuffer + i) - load<V>(rightBuffer + i);
-							vLMax = max(vand(vInput * vHalf, vSign), vLMax);
-						}
-						break;
-					}
-				}
+		}
 
-				vRMax = vLMax;
+	inline void Oscilloscope::runPeakFilter()
+	{
+		auto & front = renderData.front;
+		auto const mode = state.channelMode;
 
-				// TODO: remainder?
+		if (front.channels.empty() || (mode != OscChannels::Left && front.channels.size() < 2))
+		{
+			shared.autoGainEnvelope.store(1, std::memory_order_release);
+			return;
+		}
 
-				suitable_container<V> lmax = vLMax, rmax = vRMax;
+		auto && leftView = front.channels[0].audioData.createProxyView();
+		auto && rightView = front.channels[front.channels.size() - 1].audioData.createProxyView();
 
-				double highestLeft = *std::max_element(lmax.begin(), lmax.end());
-				double highestRight = *std::max_element(rmax.begin(), rmax.end());
+		const std::size_t numSamples = leftView.size();
+		const auto * left = leftView.begin();
+		const auto * right = rightView.begin();
 
-				filters.envelope[0] = std::max(filters.envelope[0] * coeff, highestLeft  * highestLeft);
-				filters.envelope[1] = std::max(filters.envelope[1] * coeff, highestRight * highestRight);
+		// the envelopes are kept up to date with the window as audio arrives, so the peaks are read from a few buckets
+		// instead of scanning the window. only the oldest few samples not filling a bucket are read from the audio.
+		auto peakOf = [&](const ChannelData::EnvelopePyramid & envelope, auto && sampleAt)
+		{
+			std::size_t uncovered = 0;
+			AFloat peak = envelope.getExtremes(numSamples, uncovered).peak();
 
-				shared.autoGainEnvelope.store(1.0 / std::max(std::sqrt(filters.envelope[0]), std::sqrt(filters.envelope[1])), std::memory_order_release);
+			auto const added = static_cast<std::size_t>(std::min<std::uint64_t>(numSamples, envelope.getWritten()));
+			auto index = leftView.cursorPosition() + numSamples - added;
 
-			}
-			else
+			for (std::size_t n = 0; n < uncovered; ++n, ++index)
 			{
-				if (channelData.front.channels.size() < 2)
-				{
-					shared.autoGainEnvelope.store(1, std::memory_order_release);
-					return;
-				}
-
-				ChannelData::AudioBuffer::ProxyView views[2] = { channelData.front.channels[0].audioData.createProxyView(), channelData.front.channels[1].audioData.createProxyView() };
-
-				std::size_t numSamples = views[0].size();
-
-				const auto * leftBuffer = views[0].begin();
-				const auto * rightBuffer = views[1].begin();
+				if (index >= numSamples)
+					index -= numSamples;
 
-				auto stop = numSamples - (numSamples & (loopIncrement - 1));
-				if (stop <= 0)
-					stop = 0;
-
-				// since this runs in every frame, we need to scale the coefficient by how often this function runs
-				// (and the amount of samples)
-				double power = numSamples * (avgFps.getAverage() / juce::Time::getHighResolutionTicksPerSecond());
-				double coeff = std::pow(std::exp(-static_cast<double>(loopIncrement) / (content->envelopeWindow.getNormalizedValue() * audioStream.getAudioHistorySamplerate())), power);
-
-				switch (state.channelMode)
-				{
-				case OscChannels::Separate:
-					for (std::size_t i = 0; i < stop; i += loopIncrement)
-					{
-						auto const vLInput = load<V>(leftBuffer + i);
-						vLMax = max(vand(vLInput, vSign), vLMax);
-						auto const vRInput = load<V>(rightBuffer + i);
-						vRMax = max(vand(vRInput, vSign), vRMax);
-					}
-					break;
-				case OscChannels::MidSide:
-					for (std::size_t i = 0; i < stop; i += loopIncrement)
-					{
-						auto const vLInput = load<V>(leftBuffer + i);
-						auto const vRInput = load<V>(rightBuffer + i);
+				peak = std::max(peak, std::abs(sampleAt(index)));
+			}
 
-						auto const a = vLInput + vRInput;
-						auto const b = vLInput - vRInput;
+			return peak;
+		};
 
-						vLMax = max(vand(a * vHalf, vSign), vLMax);
-						vRMax = max(vand(b * vHalf, vSign), vRMax);
-					}
-					break;
-				}
+		auto leftAt = [&](std::size_t i) { return left[i]; };
+		auto rightAt = [&](std::size_t i) { return right[i]; };
+		// same scaling as ChannelData::Buffer::appendEnvelopes()
+		auto midAt = [&](std::size_t i) { return static_cast<AFloat>(0.5) * (left[i] + right[i]); };
+		auto sideAt = [&](std::size_t i) { return static_cast<AFloat>(0.5) * (left[i] - right[i]); };
 
-				// TODO: remainder?
+		double highestLeft = 0, highestRight = 0;
 
-				suitable_container<V> lmax = vLMax, rmax = vRMax;
+		switch (mode)
+		{
+		case OscChannels::Left:
+			highestLeft = peakOf(front.channels[0].envelope, leftAt);
+			break;
+		case OscChannels::Right:
+			highestLeft = peakOf(front.channels[1].envelope, rightAt);
+			break;
+		case OscChannels::Mid:
+			highestLeft = peakOf(front.midSideEnvelope[0], midAt);
+			break;
+		case OscChannels::Side:
+			highestLeft = peakOf(front.midSideEnvelope[1], sideAt);
+			break;
+		case OscChannels::Separate:
+			highestLeft = peakOf(front.channels[0].envelope, leftAt);
+			highestRight = peakOf(front.channels[1].envelope, rightAt);
+			break;
+		case OscChannels::MidSide:
+			highestLeft = peakOf(front.midSideEnvelope[0], midAt);
+			highestRight = peakOf(front.midSideEnvelope[1], sideAt);
+			break;
+		}
 
-				double highestLeft = *std::max_element(lmax.begin(), lmax.end());
-				double highestRight = *std::max_element(rmax.begin(), rmax.end());
+		if (mode <= OscChannels::OffsetForMono)
+			highestRight = highestLeft;
 
-				filters.envelope[0] = std::max(filters.envelope[0] * coeff, highestLeft  * highestLeft);
-				filters.envelope[1] = std::max(filters.envelope[1] * coeff, highestRight * highestRight);
+		// since this runs in every frame, we need to scale the coefficient by how often this function runs
+		// (and the amount of samples)
+		double power = numSamples * (avgFps.getAverage() / juce::Time::getHighResolutionTicksPerSecond());
+		double coeff = std::pow(std::exp(-1.0 / (content->envelopeWindow.getNormalizedValue() * audioStream.getAudioHistorySamplerate())), power);
 
-				shared.autoGainEnvelope.store(1.0 / std::max(std::sqrt(filters.envelope[0]), std::sqrt(filters.envelope[1])), std::memory_order_release);
+		filters.envelope[0] = std::max(filters.envelope[0] * coeff, highestLeft  * highestLeft);
+		filters.envelope[1] = std::max(filters.envelope[1] * coeff, highestRight * highestRight);
 
-			}
-		}
+		shared.autoGainEnvelope.store(1.0 / std::max(std::sqrt(filters.envelope[0]), std::sqrt(filters.envelope[1])), std::memory_order_release);
+	}
 };
@@ -52,9 +52,21 @@
 				Window,
 				EnvelopeHold,
 				ZeroCrossing,
+				/// <summary>
+				/// Time-domain (YIN) estimation of the fundamental period
+				/// </summary>
+				Pitch,
 				end
 			};
 
+			/// <summary>
+			/// Whether the triggering mode follows a detected fundamental, and thus supports TimeMode::Cycles
+			/// </summary>
+			static bool isPitchTracking(TriggeringMode mode) noexcept
+			{
+				return mode == TriggeringMode::Spectral || mode == TriggeringMode::Pitch;
+			}
+
 			enum class TimeMode
 			{
 				Time, Cycles, Beats
@@ -414,6 +426,11 @@
 					, kfreqColourBlend(&parentValue.frequencyColouringBlend)
 					, ktriggerHysteresis(&parentValue.triggerHysteresis)
 					, ktriggerThreshold(&parentValue.triggerThreshold)
+					, kpersistence(&parentValue.persistence)
+					, kpersistenceDecay(&parentValue.persistenceDecay)
+					, kdiskCapture(&parentValue.diskCapture)
+					, kcaptureLength(&parentValue.captureLength)
+					, kscrollback(&parentValue.scrollback)
 
 					, editorSerializer(
 						*this,
@@ -448,10 +465,11 @@
 					{
 						for (int i = 0; i < parent.triggerMode.tsf.getQuantization(); ++i)
 						{
-							ktriggerMode.setEnabledStateFor(i, i == cpl::enum_cast<int>(TimeMode::Cycles));
+							ktriggerMode.setEnabledStateFor(i, isPitchTracking(cpl::enum_cast<TriggeringMode>(i)));
 						}
 
-						ktriggerMode.getValueReference().setTransformedValue(cpl::enum_cast<double>(TimeMode::Cycles));
+						if (!isPitchTracking(parent.triggerMode.param.getAsTEnum<TriggeringMode>()))
+							ktriggerMode.getValueReference().setTransformedValue(cpl::enum_cast<double>(TriggeringMode::Spectral));
 					}
 					else
 					{
@@ -498,6 +516,9 @@
 					kfreqColourBlend.bSetTitle("Colour blend");
 					ktriggerHysteresis.bSetTitle("Hysteresis");
 					ktriggerThreshold.bSetTitle("Trigger thrshld");
+					kpersistenceDecay.bSetTitle("Persist. decay");
+					kcaptureLength.bSetTitle("Capture length");
+					kscrollback.bSetTitle("Scrollback");
 					// buttons n controls
 
 					kantiAlias.setSingleText("Antialias");
@@ -513,6 +534,10 @@
 					koverlayChannels.setToggleable(true);
 					kcursorTracker.bSetTitle("Cursor tracker");
 					kcursorTracker.setToggleable(true);
+					kpersistence.bSetTitle("Persistence");
+					kpersistence.setToggleable(true);
+					kdiskCapture.bSetTitle("Disk capture");
+					kdiskCapture.setToggleable(true);
 
 
 					// descriptions.
@@ -531,7 +556,8 @@
 					ksubSampleInterpolationMode.bSetDescription("Controls how point samples are interpolated to wave forms");
 					kpctForDivision.bSetDescription("The minimum amount of free space that triggers a recursed frequency grid division; smaller values draw more frequency divisions.");
 					kchannelConfiguration.bSetDescription("Select how the audio channels are interpreted.");
-					ktriggerMode.bSetDescription("Select a mode for triggering waveforms - i.e. syncing to frequency content, time or transition information");
+					ktriggerMode.bSetDescription("Select a mode for triggering waveforms - i.e. syncing to frequency content, time or transition information. "
+						"Pitch estimates the period in the time domain, which is more stable for bass and voices and needs less lookahead than spectral");
 					ktriggerPhaseOffset.bSetDescription("A custom +/- full-circle offset for the phase on triggering");
 					ktimeMode.bSetDescription("Specifies the working units of the time display");
 					kdotSamples.bSetDescription("Marks sample positions when drawing subsampled interpolated lines");
@@ -548,6 +574,11 @@
 					ktrackerColour.bSetDescription("Colour of the cursor tracker");
 					ktriggerHysteresis.bSetDescription("The hysteresis of the triggering function defines an opaque measure of how resistant the trigger is to change");
 					ktriggerThreshold.bSetDescription("The triggering function will not consider any candidates below the threshold");
+					kpersistence.bSetDescription("Accumulates every drawn waveform into an intensity graded image that fades over time, like the phosphor of an analog scope");
+					kpersistenceDecay.bSetDescription("The time it takes for the persistence image to fade to about a third");
+					kdiskCapture.bSetDescription("Continuously records the audio into a temporary file on disk, so long captures don't use memory. Freeze the display and use scrollback to look through it");
+					kcaptureLength.bSetDescription("The amount of time kept by the disk capture. Changing it starts a new capture");
+					kscrollback.bSetDescription("How far back into the disk capture the display is, as a fraction of the captured audio. Zero displays the live audio");
 				}
 
 				void initUI()
@@ -594,6 +625,14 @@
 
 							page->addSection(section, "Spatial");
 						}
+						if (auto section = new Signalizer::CContentPage::MatrixSection())
+						{
+							section->addControl(&kcaptureLength, 0);
+							section->addControl(&kscrollback, 1);
+							section->addControl(&kdiskCapture, 0);
+
+							page->addSection(section, "Capture");
+						}
 					}
 
 					if (auto page = addPage("Rendering", "icons/svg/brush.svg"))
@@ -603,6 +642,7 @@
 							section->addControl(&kantiAlias, 0);
 							section->addControl(&kdiagnostics, 1);
 							section->addControl(&kdotSamples, 2);
+							section->addControl(&kpersistence, 0);
 							page->addSection(section, "Options");
 						}
 						if (auto section = new Signalizer::CContentPage::MatrixSection())
@@ -613,6 +653,7 @@
 							section->addControl(&kgraphColour, 0);
 							section->addControl(&kbackgroundColour, 1);
 							section->addControl(&ktrackerColour, 0);
+							section->addControl(&kpersistenceDecay, 1);
 
 							page->addSection(section, "Look");
 						}
@@ -679,6 +720,11 @@
 					archive << kfreqColourBlend;
 					archive << ktriggerHysteresis;
 					archive << ktriggerThreshold;
+					archive << kpersistence;
+					archive << kpersistenceDecay;
+					archive << kdiskCapture;
+					archive << kcaptureLength;
+					archive << kscrollback;
 				}
 
 				void deserializeEditorSettings(cpl::CSerializer::Archiver & builder, cpl::Version version)
@@ -727,6 +773,11 @@
 					{
 						builder >> ktriggerHysteresis;
 						builder >> ktriggerThreshold;
+						builder >> kpersistence;
+						builder >> kpersistenceDecay;
+						builder >> kdiskCapture;
+						builder >> kcaptureLength;
+						builder >> kscrollback;
 					}
 
 				}
@@ -765,11 +816,11 @@
 					}
 				}
 
-				cpl::CButton kantiAlias, kdiagnostics, kdotSamples, ktriggerOnCustomFrequency, koverlayChannels, kcursorTracker;
+				cpl::CButton kantiAlias, kdiagnostics, kdotSamples, ktriggerOnCustomFrequency, koverlayChannels, kcursorTracker, kpersistence, kdiskCapture;
 				cpl::CValueInputControl kcustomFrequency;
 				cpl::CValueKnobSlider
 					kwindow, kgain, kprimitiveSize, kenvelopeSmooth, kpctForDivision, ktriggerPhaseOffset, kcolourSmoothingTime, kfreqColourBlend,
-					ktriggerHysteresis, ktriggerThreshold;
+					ktriggerHysteresis, ktriggerThreshold, kpersistenceDecay, kcaptureLength, kscrollback;
 				cpl::CColourControl kprimaryColour, ksecondaryColour, kgraphColour, kbackgroundColour, klowColour, kmidColour, khighColour, ktrackerColour;
 				cpl::CTransformWidget ktransform;
 				cpl::CValueComboBox kenvelopeMode, ksubSampleInterpolationMode, kchannelConfiguration, ktriggerMode, ktimeMode, kchannelColouring;
@@ -796,7 +847,10 @@
 				, customTriggerRange(5, 48000)
 				, colourSmoothRange(0.001, 1000)
 				, triggerThresholdRange(0, 4)
+				, persistenceRange(10, 10000)
+				, captureLengthRange(1, 600)
 				, msFormatter("ms")
+				, secondsFormatter("s")
 				, degreeFormatter("degs")
 				, ptsFormatter("pts")
 				, customTriggerFormatter(system.getAudioStream())
@@ -824,6 +878,11 @@
 				, frequencyColouringBlend("FColBlend", unityRange, pctFormatter)
 				, triggerHysteresis("TrgHstrs", unityRange, pctFormatter)
 				, triggerThreshold("TrgThrhold", triggerThresholdRange, dbFormatter)
+				, persistence("Persist", boolRange, boolFormatter)
+				, persistenceDecay("PersDecay", persistenceRange, msFormatter)
+				, diskCapture("DiskCapt", boolRange, boolFormatter)
+				, captureLength("CaptLen", captureLengthRange, secondsFormatter)
+				, scrollback("Scrollback", unityRange, pctFormatter)
 
 				, colourBehaviour()
 				, primaryColour(colourBehaviour, "Prim.")
@@ -846,7 +905,7 @@
 				autoGain.fmt.setValues({ "None", "RMS", "Peak decay" });
 				subSampleInterpolation.fmt.setValues({ "None", "Rectangular", "Linear", "Lanczos" });
 				channelConfiguration.fmt.setValues({ "Left", "Right", "Mid", "Side", "Separate", "Mid+Side"});
-				triggerMode.fmt.setValues({ "None", "Spectral", "Window", "Envelope" , "Zero-crossing"});
+				triggerMode.fmt.setValues({ "None", "Spectral", "Window", "Envelope" , "Zero-crossing", "Pitch" });
 				timeMode.fmt.setValues({ "Time", "Cycles", "Beats" });
 				channelColouring.fmt.setValues({ "Static", "Spectral energy" });
 
@@ -894,6 +953,13 @@
 
 				parameterSet.registerParameterBundle(&transform, "3D.");
 
+				// registered last so earlier parameter indices stay stable
+				parameterSet.registerSingleParameter(persistence.generateUpdateRegistrator());
+				parameterSet.registerSingleParameter(persistenceDecay.generateUpdateRegistrator());
+				parameterSet.registerSingleParameter(diskCapture.generateUpdateRegistrator());
+				parameterSet.registerSingleParameter(captureLength.generateUpdateRegistrator());
+				parameterSet.registerSingleParameter(scrollback.generateUpdateRegistrator());
+
 				parameterSet.seal();
 				audioHistoryTransformatter.initialize(windowSize.getParameterView());
 				timeMode.param.getParameterView().addListener(this);
@@ -958,6 +1024,11 @@
 				archive << frequencyColouringBlend;
 				archive << triggerHysteresis;
 				archive << triggerThreshold;
+				archive << persistence;
+				archive << persistenceDecay;
+				archive << diskCapture;
+				archive << captureLength;
+				archive << scrollback;
 			}
 
 			virtual void deserialize(cpl::CSerializer::Builder & builder, cpl::Version version) override
@@ -1005,6 +1076,11 @@
 				{
 					builder >> triggerHysteresis;
 					builder >> triggerThreshold;
+					builder >> persistence;
+					builder >> persistenceDecay;
+					builder >> diskCapture;
+					builder >> captureLength;
+					builder >> scrollback;
 				}
 			}
 
@@ -1015,6 +1091,7 @@
 
 			cpl::UnitFormatter<double>
 				msFormatter,
+				secondsFormatter,
 				degreeFormatter,
 				ptsFormatter;
 
@@ -1027,7 +1104,7 @@
 			cpl::BasicFormatter<double> basicFormatter;
 			cpl::BooleanRange<double> boolRange;
 
-			cpl::ExponentialRange<double> dbRange, colourSmoothRange;
+			cpl::ExponentialRange<double> dbRange, colourSmoothRange, persistenceRange, captureLengthRange;
 
 			cpl::LinearRange<double>
 				ptsRange,
@@ -1062,7 +1139,12 @@
 				cursorTracker,
 				frequencyColouringBlend,
 				triggerHysteresis,
-				triggerThreshold;
+				triggerThreshold,
+				persistence,
+				persistenceDecay,
+				diskCapture,
+				captureLength,
+				scrollback;
 
 			std::vector<cpl::ParameterValue<ParameterSet::ParameterView>> viewOffsets;
 
@@ -30,6 +30,7 @@
 
 #include "Oscilloscope.h"
 #include <cstdint>
+#include <numeric>
 #include <cpl/CMutex.h>
 #include <cpl/Mathext.h>
 #include <cpl/rendering/OpenGLRasterizers.h>
@@ -37,16 +38,76 @@
 #include <cpl/special/AxisTools.h>
 #include "SampleColourEvaluators.h"
 #include "OscilloscopeDSP.inl"
+#include "StreamPreprocessing.h"
 
 namespace Signalizer
 {
 
     using namespace juce::gl;
 
+	namespace detail
+	{
+		/// <summary>
+		/// Writes the lanes of x and y as interleaved (x, y) pairs.
+		/// </summary>
+		inline void storePairs(float * out, float x, float y) noexcept { out[0] = x; out[1] = y; }
+
+		inline void storePairs(float * out, __m128 x, __m128 y) noexcept
+		{
+			_mm_storeu_ps(out, _mm_unpacklo_ps(x, y));
+			_mm_storeu_ps(out + 4, _mm_unpackhi_ps(x, y));
+		}
+
+		inline void storePairs(float * out, __m256 x, __m256 y) noexcept
+		{
+			// the unpacks work inside 128 bit halves, which are put back in order when stored
+			const __m256 low = _mm256_unpacklo_ps(x, y), high = _mm256_unpackhi_ps(x, y);
+			_mm256_storeu_ps(out, _mm256_permute2f128_ps(low, high, 0x20));
+			_mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(low, high, 0x31));
+		}
+
+		/// <summary>
+		/// Writes the two vertices of a step for each lane: (x, y) and (x + 1, y).
+		/// </summary>
+		inline void storeSteps(float * out, float x, float y) noexcept { out[0] = x; out[1] = y; out[2] = x + 1; out[3] = y; }
+
+		inline void storeSteps(float * out, __m128 x, __m128 y) noexcept
+		{
+			const __m128 next = _mm_add_ps(x, _mm_set1_ps(1));
+			// pairs of floats are moved as doubles
+			const __m128d
+				low = _mm_castps_pd(_mm_unpacklo_ps(x, y)), high = _mm_castps_pd(_mm_unpackhi_ps(x, y)),
+				nextLow = _mm_castps_pd(_mm_unpacklo_ps(next, y)), nextHigh = _mm_castps_pd(_mm_unpackhi_ps(next, y));
+
+			_mm_storeu_ps(out, _mm_castpd_ps(_mm_unpacklo_pd(low, nextLow)));
+			_mm_storeu_ps(out + 4, _mm_castpd_ps(_mm_unpackhi_pd(low, nextLow)));
+			_mm_storeu_ps(out + 8, _mm_castpd_ps(_mm_unpacklo_pd(high, nextHigh)));
+			_mm_storeu_ps(out + 12, _mm_castpd_ps(_mm_unpackhi_pd(high, nextHigh)));
+		}
+
+		inline void storeSteps(float * out, __m256 x, __m256 y) noexcept
+		{
+			const __m256 next = _mm256_add_ps(x, _mm256_set1_ps(1));
+			const __m256d
+				low = _mm256_castps_pd(_mm256_unpacklo_ps(x, y)), high = _mm256_castps_pd(_mm256_unpackhi_ps(x, y)),
+				nextLow = _mm256_castps_pd(_mm256_unpacklo_ps(next, y)), nextHigh = _mm256_castps_pd(_mm256_unpackhi_ps(next, y));
+
+			// steps of lanes 0, 4 | 1, 5 | 2, 6 | 3, 7
+			const __m256d
+				first = _mm256_unpacklo_pd(low, nextLow), second = _mm256_unpackhi_pd(low, nextLow),
+				third = _mm256_unpacklo_pd(high, nextHigh), fourth = _mm256_unpackhi_pd(high, nextHigh);
+
+			_mm256_storeu_ps(out, _mm256_castpd_ps(_mm256_permute2f128_pd(first, second, 0x20)));
+			_mm256_storeu_ps(out + 8, _mm256_castpd_ps(_mm256_permute2f128_pd(third, fourth, 0x20)));
+			_mm256_storeu_ps(out + 16, _mm256_castpd_ps(_mm256_permute2f128_pd(first, second, 0x31)));
+			_mm256_storeu_ps(out + 24, _mm256_castpd_ps(_mm256_permute2f128_pd(third, fourth, 0x31)));
+		}
+	};
+
 	struct VerticalScreenSplitter
 	{
-		VerticalScreenSplitter(juce::Rectangle<int> clipRectangle, cpl::OpenGLRendering::COpenGLStack & stack, bool doSeparate)
-			: stack(stack), width(clipRectangle.getWidth()), halfHeight(clipRectangle.getHeight() >> 1), separate(doSeparate)
+		VerticalScreenSplitter(juce::Rectangle<int> clipRectangle, cpl::OpenGLRendering::COpenGLStack & stack, LineTransform & view, bool doSeparate)
+			: stack(stack), view(view), oldView(view), width(clipRectangle.getWidth()), halfHeight(clipRectangle.getHeight() >> 1), separate(doSeparate)
 		{
 
 		}
@@ -57,6 +118,7 @@ namespace Signalizer
 			{
 				m.scale(1, 0.5f, 1);
 				m.translate(0, 1, 0);
+				view.scale(1, 0.5f, 1).translate(0, 1, 0);
 				stack.enable(GL_SCISSOR_TEST);
 				glScissor(0, halfHeight, width, halfHeight);
 			}
@@ -67,17 +129,102 @@ namespace Signalizer
 			if (separate)
 			{
 				m.translate(0, -2, 0);
+				view.translate(0, -2, 0);
 				glScissor(0, 0, width, halfHeight);
 			}
 		}
 
-		~VerticalScreenSplitter() { if (separate) stack.disable(GL_SCISSOR_TEST); }
+		~VerticalScreenSplitter() { view = oldView; if (separate) stack.disable(GL_SCISSOR_TEST); }
 		cpl::OpenGLRendering::MatrixModification m;
 		cpl::OpenGLRendering::COpenGLStack & stack;
+		// mirrors m for the line shader
+		LineTransform & view, oldView;
 		GLint width, halfHeight;
 		bool separate;
 	};
 
+	/// <summary>
+	/// Lanczos kernels of OscilloscopeContent::InterpolationKernelSize, precomputed for a fixed amount of fractional phases.
+	/// Row p weights the Taps samples starting Size - 1 samples before the one the point p / Phases is relative to.
+	/// Rows are padded with zeroes to Stride, so they can be consumed a vector at a time.
+	/// </summary>
+	class PolyphaseLanczos
+	{
+	public:
+
+		static const std::size_t Size = OscilloscopeContent::InterpolationKernelSize;
+		static const std::size_t Phases = 256;
+		static const std::size_t Taps = Size * 2;
+		static const std::size_t Stride = (Taps + 7) & ~std::size_t(7);
+
+		static const PolyphaseLanczos & get()
+		{
+			static const PolyphaseLanczos table;
+			return table;
+		}
+
+		/// <summary>
+		/// Returns the weights for the fraction, in [0, 1].
+		/// </summary>
+		const AFloat * getRow(double fraction) const noexcept
+		{
+			return weights.data() + static_cast<std::size_t>(fraction * Phases + 0.5) * Stride;
+		}
+
+	private:
+
+		PolyphaseLanczos()
+			: weights((Phases + 1) * Stride, 0)
+		{
+			auto const pi = cpl::simd::consts<double>::pi;
+
+			auto kernel = [pi](double x)
+			{
+				if (x == 0)
+					return 1.0;
+
+				if (std::abs(x) >= Size)
+					return 0.0;
+
+				return Size * std::sin(pi * x) * std::sin(pi * x / Size) / (pi * pi * x * x);
+			};
+
+			// including the fraction 1, so rounding never needs to move to the next sample
+			for (std::size_t p = 0; p <= Phases; ++p)
+			{
+				auto const fraction = static_cast<double>(p) / Phases;
+
+				for (std::size_t t = 0; t < Taps; ++t)
+					weights[p * Stride + t] = static_cast<AFloat>(kernel(Size - 1 - static_cast<double>(t) + fraction));
+			}
+		}
+
+		cpl::aligned_vector<AFloat, 32> weights;
+	};
+
+	template<typename ISA>
+	inline AFloat dotProduct(const AFloat * aligned, const AFloat * b, std::size_t size) noexcept
+	{
+		using namespace cpl::simd;
+		typedef typename ISA::V V;
+
+		auto const lanes = elements_of<V>::value;
+		auto const stop = size - (size & (lanes - 1));
+
+		V vSum = zero<V>();
+
+		for (std::size_t i = 0; i < stop; i += lanes)
+			vSum += load<V>(aligned + i) * loadu<V>(b + i);
+
+		suitable_container<V> sums = vSum;
+		AFloat sum = std::accumulate(sums.begin(), sums.end(), AFloat(0));
+
+		for (std::size_t i = stop; i < size; ++i)
+			sum += aligned[i] * b[i];
+
+		return sum;
+	}
+
 	template<typename ISA>
 	void Oscilloscope::paint2DGraphics(juce::Graphics & g)
 	{
@@ -91,7 +238,8 @@ namespace Signalizer
 			auto totalCycles = renderCycles + cpl::Misc::ClockCounter() - cStart;
 			double cpuTime = (double(totalCycles) / (processorSpeed * 1000 * 1000) * 100) * fps;
 			g.setColour(juce::Colours::blue);
-			sprintf(textbuf.get(), "%dx%d: %.1f fps - %.1f%% cpu, deltaG = %f, deltaO = %f (rt: %.2f%% - %.2f%%), (as: %.2f%% - %.2f%%), qHZ: %.5f - HZ: %.5f - PHASE: %.5f",
+			auto & triggers = triggerState.preprocessingTrigger->getTriggerQueue();
+			sprintf(textbuf.get(), "%dx%d: %.1f fps - %.1f%% cpu, deltaG = %f, deltaO = %f (rt: %.2f%% - %.2f%%), (as: %.2f%% - %.2f%%), qHZ: %.5f - HZ: %.5f - PHASE: %.5f, triggers: %llu (%llu dropped, %llu queued)",
 				getWidth(), getHeight(), fps, cpuTime, graphicsDeltaTime(), openGLDeltaTime(),
 				100 * audioStream.getPerfMeasures().rtUsage.load(std::memory_order_relaxed),
 				100 * audioStream.getPerfMeasures().rtOverhead.load(std::memory_order_relaxed),
@@ -99,7 +247,10 @@ namespace Signalizer
 				100 * audioStream.getPerfMeasures().asyncOverhead.load(std::memory_order_relaxed),
 				(double)triggerState.record.index,
 				triggerState.fundamental,
-				triggerState.sampleOffset);
+				triggerState.sampleOffset,
+				static_cast<unsigned long long>(triggers.getPushedCount()),
+				static_cast<unsigned long long>(triggers.getDroppedCount()),
+				static_cast<unsigned long long>(triggers.getQueuedCount()));
 			g.drawSingleLineText(textbuf.get(), 10, 20);
 
 		}
@@ -226,12 +377,13 @@ namespace Signalizer
 
 	void Oscilloscope::initOpenGL()
 	{
-
+		lineStream.create();
 	}
 
 	void Oscilloscope::closeOpenGL()
 	{
-
+		persistence.image.release();
+		lineStream.release();
 	}
 
 	void Oscilloscope::onOpenGLRendering()
@@ -241,7 +393,7 @@ namespace Signalizer
 
 	bool Oscilloscope::checkAndInformInvalidCombinations()
 	{
-		if (state.timeMode == OscilloscopeContent::TimeMode::Cycles && state.triggerMode != OscilloscopeContent::TriggeringMode::Spectral)
+		if (state.timeMode == OscilloscopeContent::TimeMode::Cycles && !OscilloscopeContent::isPitchTracking(state.triggerMode))
 		{
 			renderGraphics(
 				[&](juce::Graphics & g)
@@ -264,10 +416,70 @@ namespace Signalizer
             CPL_DEBUGCHECKGL();
             
 			{
-                cpl::CMutex lock(bufferLock);
-                
-                handleFlagUpdates();
-                
+				std::size_t window = 0;
+				bool scrolledBack = false;
+
+				{
+					// only hold the lock while the shared state is updated, and the live read window copied
+					cpl::CMutex lock(bufferLock);
+
+					handleFlagUpdates();
+					calculateFundamentalPeriod();
+					resizeAudioStorage();
+
+					// creating and deleting capture files is slow, so it is done by the capture's worker. a new capture starts once it is ready.
+					capture.request(
+						state.diskCapture
+							? DiskCapture::Storage::roundToPages(static_cast<std::size_t>(content->captureLength.getTransformedValue() * audioStream.getAudioHistorySamplerate()))
+							: 0
+					);
+
+					window = channelData.front.channels[0].audioData.getSize();
+					const auto range = capture.getRange();
+
+					captureView.window = std::min(window, range.size());
+
+					if (captureView.window == 0)
+					{
+						// anchor again once there is something to scroll through
+						captureView.scrollback = -1;
+					}
+					else if (state.scrollback != captureView.scrollback || state.scrollback == 0)
+					{
+						// the view is anchored to the captured frames it was scrolled to, instead of following the capture
+						captureView.scrollback = state.scrollback;
+						captureView.end = range.newest - static_cast<std::uint64_t>(state.scrollback * (range.size() - captureView.window));
+					}
+
+					// until the capture runs past it
+					captureView.end = std::min(std::max(captureView.end, range.oldest + captureView.window), range.newest);
+					captureView.framesAgo = range.newest - captureView.end;
+
+					// scrolled back displays read their window from the disk capture instead, once the lock is released
+					scrolledBack = state.scrollback > 0 && captureView.window > 0;
+
+					if (scrolledBack)
+						renderData.captureKeys(channelData);
+					else
+						renderData.captureSnapshot(channelData, renderDataVersion);
+
+					// only the newest triggered window is displayed, but the persistence counts the ones replaced between frames
+					auto const publishedWindows = channelData.getPublishedWindows();
+					persistence.newWindows = publishedWindows - persistence.seenWindows;
+					persistence.seenWindows = publishedWindows;
+
+					// stored colours are decoded with the current colours, so changes also apply to the history
+					renderData.designColours({ { state.colourLow, state.colourMid, state.colourHigh } }, state.colourPrimary, state.colourSecondary, static_cast<AFloat>(state.colourBlend));
+
+				}
+
+				// only reread if the view moved, or the window changed
+				if (scrolledBack)
+					capture.readWindow(renderData, window, captureView.end, renderDataVersion);
+
+				if (state.diskCapture)
+					capture.copySummaries(captureView.pages);
+
                 juce::OpenGLHelpers::clear(state.colourBackground);
                 
                 if (!checkAndInformInvalidCombinations())
@@ -290,10 +502,13 @@ namespace Signalizer
 
 				auto mode = state.channelMode;
 
-				if (mode > OscChannels::OffsetForMono && channelData.front.channels.size() < 2)
+				if (mode > OscChannels::OffsetForMono && renderData.front.channels.size() < 2)
 					mode = OscChannels::Left;
 
-				if (channelData.front.channels.size() > 0 && channelData.filterStates.channels.size() > 0)
+				if (state.persistence)
+					decayPersistence<ISA>();
+
+				if (renderData.front.channels.size() > 0 && renderData.filterStates.channels.size() > 0)
 				{
 					switch (mode)
 					{
@@ -315,7 +530,7 @@ namespace Signalizer
 						break;
 					case OscChannels::Separate:
 					{
-						VerticalScreenSplitter w(getLocalBounds() * oglc->getRenderingScale(), openGLStack, !state.overlayChannels);
+						VerticalScreenSplitter w(getLocalBounds() * oglc->getRenderingScale(), openGLStack, splitView, !state.overlayChannels);
 						analyseAndSetupState<ISA, SampleColourEvaluator<OscChannels::Left, 0>>();
 						w.firstPass();
 						drawWavePlot<ISA, SampleColourEvaluator<OscChannels::Left, 0>>(openGLStack);
@@ -325,7 +540,7 @@ namespace Signalizer
 					}
 					case OscChannels::MidSide:
 					{
-						VerticalScreenSplitter w(getLocalBounds() * oglc->getRenderingScale(), openGLStack, !state.overlayChannels);
+						VerticalScreenSplitter w(getLocalBounds() * oglc->getRenderingScale(), openGLStack, splitView, !state.overlayChannels);
 						analyseAndSetupState<ISA, SampleColourEvaluator<OscChannels::Mid, 0>>();
 						w.firstPass();
 						drawWavePlot<ISA, SampleColourEvaluator<OscChannels::Mid, 0>>(openGLStack);
@@ -336,6 +551,11 @@ namespace Signalizer
 					}
 				}
 
+				if (state.persistence)
+					drawPersistence<ISA>(openGLStack);
+
+				if (state.diskCapture)
+					drawCaptureOverview(openGLStack);
 
 				CPL_DEBUGCHECKGL();
 
@@ -532,11 +752,292 @@ namespace Signalizer
 		}
 	}
 
+	Oscilloscope::SampleSpace Oscilloscope::calculateSampleSpace(SubSampleInterpolation interpolation) const noexcept
+	{
+		SampleSpace space;
+
+		cpl::ssize_t
+			roundedWindow = static_cast<cpl::ssize_t>(std::ceil(state.effectiveWindowSize)),
+			quantizedCycleSamples(0);
+
+		const auto sizeMinusOne = std::max(1.0, state.effectiveWindowSize - 1);
+		cpl::ssize_t bufferOffset = 0;
+		double subSampleOffset = 0, offset = 0;
+
+		if (state.triggerMode == OscilloscopeContent::TriggeringMode::Window)
+		{
+			auto const realOffset = std::fmod(state.transportPosition, state.effectiveWindowSize);
+			bufferOffset = static_cast<cpl::ssize_t>(std::ceil(realOffset));
+			offset = subSampleOffset = 0;
+		}
+		else if (state.triggerMode == OscilloscopeContent::TriggeringMode::EnvelopeHold || state.triggerMode == OscilloscopeContent::TriggeringMode::ZeroCrossing)
+		{
+			auto const realOffset = triggerState.sampleOffset;
+			bufferOffset = static_cast<cpl::ssize_t>(std::ceil(realOffset));
+			subSampleOffset = bufferOffset - realOffset;
+			offset += (1 - subSampleOffset) / sizeMinusOne;
+		}
+		else
+		{
+			// TODO: FIX. This causes an extra cycle to be rendered for lanczos so it has more to eat from the edges.
+			auto const cycleBuffers = interpolation == SubSampleInterpolation::Lanczos ? 2 : 1;
+			// calculate fractionate offsets used for sample-space rendering
+			if (state.triggerMode != OscilloscopeContent::TriggeringMode::None)
+			{
+				quantizedCycleSamples = static_cast<cpl::ssize_t>(std::ceil(triggerState.cycleSamples));
+				subSampleOffset = cycleBuffers * (quantizedCycleSamples - triggerState.cycleSamples) + (roundedWindow - state.effectiveWindowSize);
+				offset = -triggerState.sampleOffset / sizeMinusOne;
+			}
+			bufferOffset = roundedWindow + cycleBuffers * quantizedCycleSamples;
+			offset += (1 - subSampleOffset) / sizeMinusOne;
+		}
+
+		space.roundedWindow = std::max<cpl::ssize_t>(2, roundedWindow);
+		space.quantizedCycleSamples = quantizedCycleSamples;
+		space.bufferOffset = bufferOffset;
+		space.sampleDisplacement = 1.0 / sizeMinusOne;
+		space.offset = offset;
+
+		return space;
+	}
+
 	template<typename ISA, typename Evaluator>
-		void Oscilloscope::drawWavePlot(cpl::OpenGLRendering::COpenGLStack & openGLStack)
+		std::size_t Oscilloscope::generateVertices(const Evaluator & eval, cpl::ssize_t offset, std::size_t count, bool steps, bool coloured)
+		{
+			using namespace cpl::simd;
+			typedef typename ISA::V V;
+			typedef typename Evaluator::AudioIt AudioIt;
+
+			const auto lanes = elements_of<V>::value;
+			const auto inputs = eval.audioSpans(offset, count);
+			const auto verticesPerSample = steps ? 2 : 1;
+
+			count = inputs[0].size();
+
+			auto & vertices = vertexBuffer.vertices;
+
+			if (vertices.size() < count * verticesPerSample * 2)
+				vertices.resize(count * verticesPerSample * 2);
+
+			auto const out = vertices.data();
+
+			// the samples after the last whole vector of a part
+			auto emit = [&](std::size_t n, GLfloat y)
+			{
+				if (!steps)
+				{
+					out[n * 2] = static_cast<GLfloat>(n);
+					out[n * 2 + 1] = y;
+				}
+				else
+				{
+					out[n * 4] = static_cast<GLfloat>(n);
+					out[n * 4 + 1] = y;
+					out[n * 4 + 2] = static_cast<GLfloat>(n + 1);
+					out[n * 4 + 3] = y;
+				}
+			};
+
+			const V vHalf = set1<V>(static_cast<AFloat>(0.5));
+			const V vLanes = set1<V>(static_cast<AFloat>(lanes));
+
+			// the x coordinates of the vertices are the sample indices
+			suitable_container<V> ramp;
+
+			for (std::size_t l = 0; l < lanes; ++l)
+				ramp[l] = static_cast<AFloat>(l);
+
+			const V vRamp = ramp;
+			std::size_t n = 0;
+
+			// walk the two contiguous parts of the ring, a vector at a time
+			for (std::size_t part = 0; part < 2; ++part)
+			{
+				const std::size_t size = part == 0 ? inputs[0].firstSize : inputs[0].secondSize;
+				AudioIt streams[Evaluator::Inputs];
+
+				for (std::size_t k = 0; k < Evaluator::Inputs; ++k)
+					streams[k] = part == 0 ? inputs[k].first : inputs[k].second;
+
+				std::size_t i = 0;
+				V vX = vRamp + set1<V>(static_cast<AFloat>(n));
+
+				for (; i + lanes <= size; i += lanes)
+				{
+					V vInputs[Evaluator::Inputs];
+
+					for (std::size_t k = 0; k < Evaluator::Inputs; ++k)
+						vInputs[k] = loadu<V>(&streams[k][i]);
+
+					const V samples = Evaluator::mix(vInputs, vHalf);
+
+					if (!steps)
+						detail::storePairs(out + n * 2, vX, samples);
+					else
+						detail::storeSteps(out + n * 4, vX, samples);
+
+					vX += vLanes;
+					n += lanes;
+				}
+
+				for (; i < size; ++i)
+				{
+					AFloat scalarInputs[Evaluator::Inputs];
+
+					for (std::size_t k = 0; k < Evaluator::Inputs; ++k)
+						scalarInputs[k] = streams[k][i];
+
+					emit(n++, Evaluator::mix(scalarInputs, static_cast<AFloat>(0.5)));
+				}
+			}
+
+			if (coloured)
+			{
+				auto & colours = vertexBuffer.colours;
+
+				if (colours.size() < count * verticesPerSample)
+					colours.resize(count * verticesPerSample);
+
+				const auto span = eval.colourSpan(offset, count);
+				const auto & decode = eval.getColourDecoder();
+
+				if (!steps)
+				{
+					auto end = std::transform(span.first, span.first + span.firstSize, colours.begin(), decode);
+					std::transform(span.second, span.second + span.secondSize, end, decode);
+				}
+				else if(span.size())
+				{
+					// a step starts in the colour of the previous sample
+					auto previous = decode(*span.first);
+					std::size_t c = 0;
+
+					auto steppedCopy = [&](auto it, std::size_t size)
+					{
+						for (std::size_t i = 0; i < size; ++i)
+						{
+							colours[c++] = previous;
+							colours[c++] = previous = decode(it[i]);
+						}
+					};
+
+					steppedCopy(span.first, span.firstSize);
+					steppedCopy(span.second, span.secondSize);
+				}
+
+				// the colour ring may be smaller than the audio
+				if (span.size() < count)
+					std::fill(colours.begin() + span.size() * verticesPerSample, colours.begin() + count * verticesPerSample, eval.getDefaultKey());
+			}
+
+			return count * verticesPerSample;
+		}
+
+	void Oscilloscope::drawVertices(GLenum primitive, std::size_t vertices, bool coloured, ChannelData::PixelType key, const LineTransform & view)
+	{
+		static_assert(sizeof(ChannelData::PixelType) == 4, "Colours are passed as 4 unsigned bytes");
+
+		if (vertices == 0)
+			return;
+
+		if (primitive == GL_LINE_STRIP && lineStream.isCreated())
+		{
+			const auto * xy = vertexBuffer.vertices.data();
+			const auto * colours = vertexBuffer.colours.data();
+
+			auto toColour = [](const ChannelData::PixelType & p)
+			{
+				return LineGeometry::Colour{ p.pixel.r, p.pixel.g, p.pixel.b, p.pixel.a };
+			};
+
+			const auto keyColour = toColour(key);
+
+			lineGeometry.clear();
+			lineGeometry.addStrip(
+				vertices,
+				[xy](std::size_t i) { return LineGeometry::Point{ xy[2 * i], xy[2 * i + 1], 0 }; },
+				[&](std::size_t i) { return coloured ? toColour(colours[i]) : keyColour; }
+			);
+
+			lineStream.draw(lineGeometry, view, static_cast<float>(oglc->getRenderingScale()) * state.primitiveSize, state.antialias);
+			return;
+		}
+
+		if (!coloured)
+			glColor4ub(key.pixel.r, key.pixel.g, key.pixel.b, key.pixel.a);
+
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glVertexPointer(2, GL_FLOAT, 0, vertexBuffer.vertices.data());
+
+		if (coloured)
 		{
+			glEnableClientState(GL_COLOR_ARRAY);
+			glColorPointer(4, GL_UNSIGNED_BYTE, 0, vertexBuffer.colours.data());
+		}
+
+		glDrawArrays(primitive, 0, static_cast<GLsizei>(vertices));
+
+		if (coloured)
+			glDisableClientState(GL_COLOR_ARRAY);
+
+		glDisableClientState(GL_VERTEX_ARRAY);
+	}
+
+	void Oscilloscope::drawCaptureOverview(cpl::OpenGLRendering::COpenGLStack & openGLStack)
+	{
+		const auto & pages = captureView.pages;
+
+		if (pages.empty())
+			return;
+
+		cpl::OpenGLRendering::MatrixModification m;
+		// x in pages, y in [-1, 1] onto the bottom tenth of the view
+		m.translate(-1, -0.9f, 0);
+		m.scale(2.0f / pages.size(), 0.1f, 1);
+
+		{
+			cpl::OpenGLRendering::PrimitiveDrawer<1024> drawer(openGLStack, GL_LINES);
+			drawer.addColour(state.colourGraph);
+
+			for (std::size_t i = 0; i < pages.size(); ++i)
+			{
+				AFloat low = 0, high = 0;
+
+				for (auto & extremes : pages[i])
+				{
+					low = std::min(low, extremes.low);
+					high = std::max(high, extremes.high);
+				}
+
+				const auto x = static_cast<GLfloat>(i + 0.5);
+				drawer.addVertex(x, std::max<AFloat>(-1, low), 0);
+				drawer.addVertex(x, std::min<AFloat>(1, high), 0);
+			}
+		}
+
+		if (captureView.window == 0)
+			return;
 
-			typedef cpl::OpenGLRendering::PrimitiveDrawer<1024> Renderer;
+		// the displayed window, relative to the newest page
+		const auto right = static_cast<GLfloat>(pages.size() - static_cast<double>(captureView.framesAgo) / DiskCapture::PageFrames);
+		const auto left = right - static_cast<GLfloat>(static_cast<double>(captureView.window) / DiskCapture::PageFrames);
+
+		cpl::OpenGLRendering::PrimitiveDrawer<8> drawer(openGLStack, GL_LINE_LOOP);
+		drawer.addColour(state.colourTracker);
+		drawer.addVertex(left, -1, 0);
+		drawer.addVertex(right, -1, 0);
+		drawer.addVertex(right, 1, 0);
+		drawer.addVertex(left, 1, 0);
+	}
+
+	template<typename ISA, typename Evaluator>
+		void Oscilloscope::drawWavePlot(cpl::OpenGLRendering::COpenGLStack & openGLStack)
+		{
+			if (state.persistence)
+			{
+				accumulatePersistence<ISA, Evaluator>();
+				return;
+			}
 
 			cpl::OpenGLRendering::MatrixModification matrixMod;
 			// and apply the gain:
@@ -552,14 +1053,7 @@ namespace Signalizer
 			auto horizontalDelta = right - left;
 
 
-			cpl::ssize_t
-				roundedWindow = static_cast<cpl::ssize_t>(std::ceil(state.effectiveWindowSize)),
-				quantizedCycleSamples(0);
-
 			const auto sizeMinusOne = std::max(1.0, state.effectiveWindowSize - 1);
-			const auto sampleDisplacement = 1.0 / sizeMinusOne;
-			cpl::ssize_t bufferOffset = 0;
-			double subSampleOffset = 0, offset = 0;
 			auto const pixelsPerSample = oglc->getRenderingScale() * std::abs((getWidth() - 1) / (sizeMinusOne * (horizontalDelta)));
 
 
@@ -569,36 +1063,15 @@ namespace Signalizer
 				interpolation = SubSampleInterpolation::Linear;
 			}
 
-			if (state.triggerMode == OscilloscopeContent::TriggeringMode::Window)
-			{
-				auto const realOffset = std::fmod(state.transportPosition, state.effectiveWindowSize);
-				bufferOffset = static_cast<cpl::ssize_t>(std::ceil(realOffset));
-				offset = subSampleOffset = 0;
-			}
-			else if (state.triggerMode == OscilloscopeContent::TriggeringMode::EnvelopeHold || state.triggerMode == OscilloscopeContent::TriggeringMode::ZeroCrossing)
-			{
-				auto const realOffset = triggerState.sampleOffset;
-				bufferOffset = static_cast<cpl::ssize_t>(std::ceil(realOffset));
-				subSampleOffset = bufferOffset - realOffset;
-				offset += (1 - subSampleOffset) / sizeMinusOne;
-			}
-			else
-			{
-				// TODO: FIX. This causes an extra cycle to be rendered for lanczos so it has more to eat from the edges.
-				auto const cycleBuffers = interpolation == SubSampleInterpolation::Lanczos ? 2 : 1;
-				// calculate fractionate offsets used for sample-space rendering
-				if (state.triggerMode != OscilloscopeContent::TriggeringMode::None)
-				{
-					quantizedCycleSamples = static_cast<cpl::ssize_t>(std::ceil(triggerState.cycleSamples));
-					subSampleOffset = cycleBuffers * (quantizedCycleSamples - triggerState.cycleSamples) + (roundedWindow - state.effectiveWindowSize);
-					offset = -triggerState.sampleOffset / sizeMinusOne;
-				}
-				bufferOffset = roundedWindow + cycleBuffers * quantizedCycleSamples;
-				offset += (1 - subSampleOffset) / sizeMinusOne;
-			}
+			const auto space = calculateSampleSpace(interpolation);
+			const auto sampleDisplacement = space.sampleDisplacement;
 
+			cpl::ssize_t
+				roundedWindow = space.roundedWindow,
+				quantizedCycleSamples = space.quantizedCycleSamples,
+				bufferOffset = space.bufferOffset;
 
-			roundedWindow = std::max<cpl::ssize_t>(2, roundedWindow);
+			double offset = space.offset;
 
 			// modify the horizontal axis into [0, 1] instead of [-1, 1]
 			matrixMod.translate(-1, 0, 0);
@@ -613,9 +1086,17 @@ namespace Signalizer
 			matrixMod.translate(0, top + (bottom - 1), 0);
 			matrixMod.scale(1, gain, 0);
 
+			// the same transformation for the line shader
+			auto view = splitView;
+			view
+				.translate(-1, 0, 0).scale(2, 1, 1)
+				.scale(static_cast<float>(1 / horizontalDelta), 1, 1).translate(static_cast<float>(-left), 0, 0)
+				.scale(1, static_cast<float>(1.0 / verticalDelta), 0).translate(0, static_cast<float>(top + (bottom - 1)), 0).scale(1, gain, 0);
+
 			const GLfloat endCondition = static_cast<GLfloat>(roundedWindow + quantizedCycleSamples /* + 2 */);
 
-			auto renderSampleSpace = [&](auto kernel, GLint primitive, cpl::ssize_t sampleOffset = 0)
+			// draws the vertices generate(evaluator, coloured) leaves in vertexBuffer, positioned in sample space
+			auto renderSampleSpace = [&](GLenum primitive, auto generate)
 			{
 				cpl::OpenGLRendering::MatrixModification m;
 				// translate triggering offset + 1
@@ -623,13 +1104,29 @@ namespace Signalizer
 				// scale to sample/pixels space
 				matrixMod.scale(sampleDisplacement, 1, 1);
 
-				Evaluator eval(channelData);
+				auto sampleView = view;
+				sampleView.translate(static_cast<float>(offset - sampleDisplacement), 0, 0).scale(static_cast<float>(sampleDisplacement), 1, 1);
+
+				Evaluator eval(renderData);
 				if (!eval.isWellDefined())
 					return;
 
-				eval.startFrom(-(bufferOffset + sampleOffset), -(bufferOffset + sampleOffset));
-				cpl::OpenGLRendering::PrimitiveDrawer<1024> drawer(openGLStack, primitive);
-				kernel(eval, drawer);
+				const bool coloured = state.colourChannelsByFrequency;
+				const std::size_t vertices = generate(eval, coloured);
+
+				drawVertices(primitive, vertices, coloured, eval.getDefaultKey(), sampleView);
+			};
+
+			// the samples themselves, generated a block at a time
+			auto renderVertices = [&](GLenum primitive, bool steps, cpl::ssize_t sampleOffset = 0)
+			{
+				renderSampleSpace(
+					primitive,
+					[&] (auto & evaluator, bool coloured)
+					{
+						return generateVertices<ISA>(evaluator, -(bufferOffset + sampleOffset), static_cast<std::size_t>(endCondition), steps, coloured);
+					}
+				);
 			};
 
 			auto dotSamples = [&] (cpl::ssize_t offset)
@@ -643,40 +1140,7 @@ namespace Signalizer
                     openGLStack.setPointSize(oldPointSize * 4 * normScale);
 				}
 
-				if (state.colourChannelsByFrequency)
-				{
-					renderSampleSpace(
-						// nested lambda auto evaluation fails on vc 2015
-						[&] (Evaluator & evaluator, Renderer & drawer)
-						{
-							for (GLfloat i = 0; i < endCondition; i += 1)
-							{
-								const auto data = evaluator.evaluate();
-								drawer.addColour(data.second);
-								drawer.addVertex(i, data.first, 0);
-								evaluator.inc();
-							}
-						},
-						GL_POINTS,
-						offset
-					);
-				}
-				else
-				{
-					renderSampleSpace(
-						[&] (Evaluator & evaluator, Renderer & drawer)
-						{
-							drawer.addColour(evaluator.getDefaultKey());
-
-							for (GLfloat i = 0; i < endCondition; i += 1)
-							{
-								drawer.addVertex(i, evaluator.evaluateSampleInc(), 0);
-							}
-						},
-						GL_POINTS,
-						offset
-					);
-				}
+				renderVertices(GL_POINTS, false, offset);
 				openGLStack.setPointSize(oldPointSize);
 			};
 
@@ -686,89 +1150,90 @@ namespace Signalizer
 				dotSamples(0);
 			}
 
-			// TODO: Add scaled rendering (getAttachedContext()->getRenderingScale())
-			switch (interpolation)
+			auto const samplesPerPixel = 1.0 / pixelsPerSample;
+
+			// when several samples share a pixel column, draw the min/max envelope of the columns instead;
+			// it doesn't alias and keeps the vertex count proportional to the width of the display.
+			if (interpolation != SubSampleInterpolation::None && samplesPerPixel >= ChannelData::EnvelopePyramid::getFactor(0))
 			{
-				case SubSampleInterpolation::Linear:
-				{
-					if (state.colourChannelsByFrequency)
+				renderSampleSpace(
+					GL_LINE_STRIP,
+					[&] (auto & evaluator, bool coloured) -> std::size_t
 					{
-						renderSampleSpace(
-							[&] (auto & evaluator, auto & drawer)
-							{
-								for (GLfloat i = 0; i < endCondition; i += 1)
-								{
-									const auto data = evaluator.evaluate();
+						auto & envelope = evaluator.getEnvelope();
+						auto const level = envelope.getLevelFor(samplesPerPixel);
+						auto const factor = static_cast<cpl::ssize_t>(envelope.getFactor(level));
+						auto const available = static_cast<cpl::ssize_t>(envelope.getAvailable(level));
 
-									drawer.addColour(data.second);
-									drawer.addVertex(i, data.first, 0);
+						// sample space position of the first sample in the newest complete bucket
+						auto const newest = bufferOffset - static_cast<cpl::ssize_t>(envelope.getPending(level)) - factor;
 
-									evaluator.inc();
-								}
-							},
-							GL_LINE_STRIP
-						);
-					}
-					else
-					{
-						renderSampleSpace(
-							[&] (auto & evaluator, auto & drawer)
-							{
-								drawer.addColour(evaluator.getDefaultKey());
-
-								for (GLfloat i = 0; i < endCondition; i += 1)
-								{
-									drawer.addVertex(i, evaluator.evaluateSampleInc(), 0);
-								}
-							},
-							GL_LINE_STRIP
-						);
-					}
+						// the visible part of the sample space, see the transformation in renderSampleSpace
+						auto const visibleBegin = std::max(0.0, (left - offset) / sampleDisplacement + 1 - factor);
+						auto const visibleEnd = std::min<double>(endCondition, (right - offset) / sampleDisplacement + 1 + factor);
 
-					break;
-				}
-				case SubSampleInterpolation::Rectangular:
-				{
-					if (state.colourChannelsByFrequency)
-					{
-						renderSampleSpace(
-							[&] (auto & evaluator, auto & drawer)
-							{
-								typename Evaluator::ColourT oldColour = evaluator.evaluateColour();
+						if (visibleEnd <= visibleBegin || available == 0)
+							return 0;
 
-								for (GLfloat i = 0; i < endCondition; i += 1)
-								{
-									const auto data = evaluator.evaluate();
+						auto const first = std::max<cpl::ssize_t>(0, static_cast<cpl::ssize_t>(std::floor((newest - visibleEnd) / factor)));
+						auto const last = std::min<cpl::ssize_t>(available - 1, static_cast<cpl::ssize_t>(std::ceil((newest + factor - visibleBegin) / factor)));
 
-									drawer.addColour(oldColour);
-									drawer.addVertex(i, data.first, 0);
-									drawer.addColour(data.second);
-									drawer.addVertex(i + 1, data.first, 0);
+						if (last < first)
+							return 0;
 
-									oldColour = data.second;
+						// two vertices per bucket
+						auto const count = static_cast<std::size_t>(last - first + 1) * 2;
+						auto & vertices = vertexBuffer.vertices;
+						auto & colours = vertexBuffer.colours;
 
-									evaluator.inc();
-								}
-							},
-							GL_LINE_STRIP
-						);
-					}
-					else
-					{
-						renderSampleSpace(
-							[&](auto & evaluator, auto & drawer)
+						if (vertices.size() < count * 2)
+							vertices.resize(count * 2);
+
+						if (coloured && colours.size() < count)
+							colours.resize(count);
+
+						std::size_t n = 0;
+
+						for (auto j = last; j >= first; --j, n += 2)
+						{
+							auto const start = newest - j * factor;
+							auto const & bucket = envelope.get(level, j);
+
+							if (coloured)
 							{
-								drawer.addColour(evaluator.getDefaultKey());
-								for (GLfloat i = 0; i < endCondition; i += 1)
-								{
-									const auto vertex = evaluator.evaluateSampleInc();
-									drawer.addVertex(i, vertex, 0);
-									drawer.addVertex(i + 1, vertex, 0);
-								}
-							},
-							GL_LINE_STRIP
-						);
+								// colour of the last sample in the bucket
+								auto const position = start + factor - 1 - bufferOffset;
+								evaluator.startFrom(position, position);
+								colours[n] = colours[n + 1] = evaluator.evaluateColour();
+							}
+
+							auto const x = static_cast<GLfloat>(start + 0.5 * (factor - 1));
+
+							// alternate the order, so the strip zigzags through the columns
+							vertices[n * 2] = x;
+							vertices[n * 2 + 1] = (j & 1) ? bucket.low : bucket.high;
+							vertices[n * 2 + 2] = x;
+							vertices[n * 2 + 3] = (j & 1) ? bucket.high : bucket.low;
+						}
+
+						return n;
 					}
+				);
+
+				return;
+			}
+
+			// TODO: Add scaled rendering (getAttachedContext()->getRenderingScale())
+			switch (interpolation)
+			{
+				case SubSampleInterpolation::Linear:
+				{
+					renderVertices(GL_LINE_STRIP, false);
+					break;
+				}
+				case SubSampleInterpolation::Rectangular:
+				{
+					renderVertices(GL_LINE_STRIP, true);
 					break;
 				}
 				case SubSampleInterpolation::Lanczos:
@@ -810,14 +1275,21 @@ namespace Signalizer
 					samplePos += -unitSpacePos / inc * samplesPerPixel;
 					double currentSample = std::floor(samplePos);
 
-					Evaluator eval(channelData);
+					Evaluator eval(renderData);
 
 					if (!eval.isWellDefined())
 						return;
 
 					eval.startFrom(-static_cast<cpl::ssize_t>(std::floor(samplePos)) - (int)KernelSize, 2 - KernelBufferSize - static_cast<cpl::ssize_t>(std::floor(samplePos)));
 
-					AFloat kernel[KernelBufferSize];
+					static_assert(PolyphaseLanczos::Size == KernelSize, "Interpolation table doesn't match the kernel");
+
+					auto const & lanczos = PolyphaseLanczos::get();
+
+					// the kernel buffer is a ring written twice, so every window of it is contiguous.
+					// the tail is only read by the zero padding of the interpolation table.
+					alignas(32) AFloat history[KernelBufferSize * 2 + PolyphaseLanczos::Stride]{};
+					std::size_t head = 0;
 
 					typename Evaluator::ColourT currentColour, nextColour;
 
@@ -831,18 +1303,19 @@ namespace Signalizer
 					};
 
 					auto insert = [&] (auto val) {
-						std::rotate(kernel, kernel + 1, kernel + KernelBufferSize);
-						kernel[KernelBufferSize - 1] = val;
+						history[head] = history[head + KernelBufferSize] = val;
+						if (++head == KernelBufferSize)
+							head = 0;
 					};
 
-					std::for_each(std::begin(kernel), std::end(kernel), [&](auto & f) { f = get(); });
+					for (std::size_t i = 0; i < KernelBufferSize; ++i)
+						insert(get());
 
 					{
-						cpl::OpenGLRendering::PrimitiveDrawer<1024> drawer(openGLStack, GL_LINE_STRIP);
-						if (!state.colourChannelsByFrequency)
-							drawer.addColour(eval.getDefaultKey());
-						else
-							drawer.addColour(currentColour);
+						const bool coloured = state.colourChannelsByFrequency;
+						auto & vertices = vertexBuffer.vertices;
+						auto & colours = vertexBuffer.colours;
+						std::size_t count = 0;
 
 						do
 						{
@@ -855,19 +1328,35 @@ namespace Signalizer
 								insert(get());
 							}
 
-							const auto interpolatedValue = cpl::dsp::lanczosFilter<double>(kernel, KernelBufferSize, (KernelSize) + delta, KernelSize);
+							// delta is in (-1, 1], so the taps stay inside the kernel buffer
+							const auto point = KernelSize + delta;
+							const auto whole = std::floor(point);
+							const auto * taps = history + head + static_cast<std::size_t>(whole) - (KernelSize - 1);
+
+							const auto interpolatedValue = dotProduct<ISA>(lanczos.getRow(point - whole), taps, PolyphaseLanczos::Stride);
+
+							if (vertices.size() < (count + 1) * 2)
+								vertices.resize(std::max<std::size_t>((count + 1) * 2, vertices.size() * 2));
 
-							if (state.colourChannelsByFrequency)
+							vertices[count * 2] = static_cast<GLfloat>(unitSpacePos);
+							vertices[count * 2 + 1] = static_cast<GLfloat>(interpolatedValue);
+
+							if (coloured)
 							{
-								drawer.addColour(currentColour.lerp(nextColour, delta));
+								if (colours.size() < count + 1)
+									colours.resize(std::max<std::size_t>(count + 1, colours.size() * 2));
+
+								colours[count] = currentColour.lerp(nextColour, delta);
 							}
 
-							drawer.addVertex(unitSpacePos, interpolatedValue, 0);
+							count++;
 							currentSample += samplesPerPixel;
 
 							unitSpacePos += inc;
 
 						} while (unitSpacePos < (right + inc));
+
+						drawVertices(GL_LINE_STRIP, count, coloured, eval.getDefaultKey(), view);
 					}
 
 
@@ -877,4 +1366,187 @@ namespace Signalizer
 			}
 
 		}
+
+	template<typename ISA>
+		void Oscilloscope::decayPersistence()
+		{
+			auto & p = persistence;
+
+			auto const scale = oglc->getRenderingScale();
+			auto const width = static_cast<std::size_t>(std::max(1.0, std::round(getWidth() * scale)));
+			auto const height = static_cast<std::size_t>(std::max(1.0, std::round(getHeight() * scale)));
+
+			if (p.image.resize(width, height))
+			{
+				p.width = width;
+				p.height = height;
+
+				for (auto & hits : p.hits)
+					hits.assign(width * height, 0);
+
+				p.used = {};
+				p.versions.fill(std::uint64_t(-1));
+			}
+
+			auto const decay = static_cast<AFloat>(p.image.advance(state.persistenceDecay));
+
+			for (std::size_t v = 0; v < Persistence::Views; ++v)
+			{
+				if (p.used[v])
+					PhosphorImage::decay<ISA>(p.hits[v].data(), width * height, decay);
+			}
+		}
+
+	template<typename ISA, typename Evaluator>
+		void Oscilloscope::accumulatePersistence()
+		{
+			auto & p = persistence;
+			auto const width = static_cast<cpl::ssize_t>(p.width), height = static_cast<cpl::ssize_t>(p.height);
+
+			if (!width || !height)
+				return;
+
+			Evaluator eval(renderData);
+
+			if (!eval.isWellDefined())
+				return;
+
+			const std::size_t slot = Evaluator::Slot;
+			auto * const hits = p.hits[slot].data();
+			p.keys[slot] = eval.getDefaultKey();
+
+			// the same window is only added once, however many frames it's displayed for
+			if (p.versions[slot] == renderDataVersion)
+				return;
+
+			p.versions[slot] = renderDataVersion;
+			p.used[slot] = true;
+
+			// untriggered windows count once per snapshot, while triggered ones may have been replaced since the last.
+			// those are added with the shape of the newest, so they at least weigh in.
+			auto const windows = static_cast<AFloat>(std::max<std::uint64_t>(1, p.newWindows));
+			p.frameWindows = std::max(p.frameWindows, windows);
+
+			const auto gain = getGain();
+
+			auto
+				left = state.viewOffsets[VO::Left],
+				right = state.viewOffsets[VO::Right],
+				top = state.viewOffsets[VO::Top],
+				bottom = state.viewOffsets[VO::Bottom];
+
+			auto verticalDelta = bottom - top;
+			auto horizontalDelta = right - left;
+
+			const auto space = calculateSampleSpace(SubSampleInterpolation::Linear);
+			const auto endCondition = space.roundedWindow + space.quantizedCycleSamples;
+
+			// same transformations as drawWavePlot() and VerticalScreenSplitter, into pixels of the image
+			const bool split = !state.overlayChannels && state.channelMode > OscChannels::OffsetForMono;
+			const double viewScale = split ? 0.5 : 1, viewOffset = split ? (slot == 0 ? 0.5 : -0.5) : 0;
+
+			auto toColumn = [&](double sample)
+			{
+				return ((sample - 1) * space.sampleDisplacement + space.offset - left) / horizontalDelta * width;
+			};
+
+			auto toRow = [&](double value)
+			{
+				auto const y = viewScale * (value * gain + top + bottom - 1) / verticalDelta + viewOffset;
+				return (y + 1) * 0.5 * height;
+			};
+
+			// adds the weight evenly over the rows a trace crosses in a column, so steep edges are dimmer than
+			// slow ones - like the beam of an analog scope.
+			auto addSpan = [&](cpl::ssize_t column, double from, double to, AFloat weight)
+			{
+				if (column < 0 || column >= width)
+					return;
+
+				if (from > to)
+					std::swap(from, to);
+
+				auto first = static_cast<cpl::ssize_t>(std::floor(from)), last = static_cast<cpl::ssize_t>(std::floor(to));
+
+				if (last < 0 || first >= height)
+					return;
+
+				auto const share = windows * weight / (last - first + 1);
+				auto * const pixels = hits + column;
+
+				first = std::max<cpl::ssize_t>(0, first);
+				last = std::min(height - 1, last);
+
+				for (auto r = first; r <= last; ++r)
+					pixels[r * width] += share;
+			};
+
+			// every column receives about one unit per window, regardless of the zoom
+			const double columnsPerSample = std::abs(toColumn(1) - toColumn(0));
+
+			eval.startFrom(-space.bufferOffset, -space.bufferOffset);
+
+			double previousColumn = toColumn(0), previousRow = toRow(eval.evaluateSampleInc());
+
+			for (cpl::ssize_t i = 1; i < endCondition; ++i)
+			{
+				const double column = toColumn(static_cast<double>(i)), row = toRow(eval.evaluateSampleInc());
+
+				if (columnsPerSample < 1)
+				{
+					addSpan(static_cast<cpl::ssize_t>(std::floor(column)), previousRow, row, static_cast<AFloat>(columnsPerSample));
+				}
+				else
+				{
+					// walk the visible columns the segment crosses, weighted by how much of each it covers
+					auto const firstColumn = std::max<cpl::ssize_t>(0, static_cast<cpl::ssize_t>(std::floor(previousColumn)));
+					auto const lastColumn = std::min<cpl::ssize_t>(width - 1, static_cast<cpl::ssize_t>(std::floor(column)));
+					auto const slope = (row - previousRow) / (column - previousColumn);
+
+					for (auto c = firstColumn; c <= lastColumn; ++c)
+					{
+						auto const begin = std::max<double>(c, previousColumn), end = std::min<double>(c + 1, column);
+
+						if (end <= begin)
+							continue;
+
+						addSpan(c, previousRow + slope * (begin - previousColumn), previousRow + slope * (end - previousColumn), static_cast<AFloat>(end - begin));
+					}
+				}
+
+				previousColumn = column;
+				previousRow = row;
+			}
+		}
+
+	template<typename ISA>
+		void Oscilloscope::drawPersistence(cpl::OpenGLRendering::COpenGLStack & openGLStack)
+		{
+			auto & p = persistence;
+
+			if (!p.width || !p.height)
+				return;
+
+			// a trace drawn at the same place every frame settles at 1 / (1 - decay per frame); normalize that to one.
+			auto const frameSeconds = avgFps.getAverage() / juce::Time::getHighResolutionTicksPerSecond();
+			auto const settled = std::max(1e-4, 1 - std::exp(-frameSeconds * 1000 / state.persistenceDecay));
+
+			// keeps a stable trace equally bright at any trigger rate, so the density shows how the windows spread
+			p.windowsPerFrame += 0.1 * (p.frameWindows - p.windowsPerFrame);
+			p.frameWindows = 0;
+			auto const exposure = 4 * settled / std::max(1.0, p.windowsPerFrame);
+
+			p.image.beginFrame();
+
+			for (std::size_t v = 0; v < Persistence::Views; ++v)
+			{
+				if (!p.used[v])
+					continue;
+
+				auto const & key = p.keys[v].pixel;
+				p.image.shade<ISA>(p.hits[v].data(), static_cast<AFloat>(exposure), juce::Colour(key.r, key.g, key.b));
+			}
+
+			p.image.draw(openGLStack);
+		}
 };
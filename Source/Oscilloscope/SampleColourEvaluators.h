@@ -59,17 +59,25 @@
 			{
 			public:
 
+				/// <summary>
+				/// Which of the two colours (and separated views) this evaluator draws with
+				/// </summary>
+				static const std::size_t Slot = ColourIndex;
+
 				SimpleChannelEvaluator(ChannelData & data)
 					: DefaultKey(data, ColourIndex)
-					, audioView(data.front.channels.at(ChannelIndex).audioData.createProxyView())
-					, colourView(data.front.channels.at(ChannelIndex).colourData.createProxyView())
+					, audioView(data.getPublishedBuffer().channels.at(ChannelIndex).audioData.createProxyView())
+					, colourView(data.getPublishedBuffer().channels.at(ChannelIndex).colourData.createProxyView())
+					, envelope(data.front.channels.at(ChannelIndex).envelope)
+					, decoder(data.colourDecoders[ColourIndex])
+					, lag(static_cast<cpl::ssize_t>(data.getPublishedLag()))
 				{
 
 				}
 
 				inline bool isWellDefined() const noexcept
 				{
-					return audioView.size() > 0 && colourView.size() > 0;
+					return audioView.size() > 0;
 				}
 
 				void startFrom(cpl::ssize_t offset)
@@ -79,7 +87,7 @@
 
 				void startFrom(cpl::ssize_t audioOffset, cpl::ssize_t colourOffset)
 				{
-					audioPointer = audioView.begin() + audioView.cursorPosition() + audioOffset;
+					audioPointer = audioView.begin() + audioView.cursorPosition() + audioOffset - lag;
 
 					while (audioPointer < audioView.begin())
 						audioPointer += audioView.size();
@@ -87,7 +95,11 @@
 					while (audioPointer >= audioView.end())
 						audioPointer -= audioView.size();
 
-					colourPointer = colourView.begin() + colourView.cursorPosition() + colourOffset;
+					// colours are only stored when colouring by frequency
+					if (colourView.size() == 0)
+						return;
+
+					colourPointer = colourView.begin() + colourView.cursorPosition() + colourOffset - lag;
 
 					while (colourPointer < colourView.begin())
 						colourPointer += colourView.size();
@@ -99,12 +111,12 @@
 
 				inline void inc() noexcept
 				{
-					audioPointer++, colourPointer++;
+					audioPointer++;
 
 					if (audioPointer == audioView.end())
 						audioPointer -= audioView.size();
 
-					if (colourPointer == colourView.end())
+					if (colourView.size() && ++colourPointer == colourView.end())
 						colourPointer -= colourView.size();
 				}
 
@@ -118,7 +130,7 @@
 
 				inline std::pair<AudioT, ColourT> evaluate() const noexcept
 				{
-					return { *audioPointer, *colourPointer };
+					return { *audioPointer, evaluateColour() };
 				}
 
 				AudioT evaluateSample() const noexcept
@@ -128,7 +140,7 @@
 
 				ColourT evaluateColour() const noexcept
 				{
-					return *colourPointer;
+					return colourView.size() ? decoder(*colourPointer) : getDefaultKey();
 				}
 
 				AudioT evaluateSampleInc() noexcept
@@ -143,7 +155,10 @@
 
 				ColourT evaluateColourInc() noexcept
 				{
-					auto ret = *colourPointer++;
+					if (!colourView.size())
+						return getDefaultKey();
+
+					auto ret = decoder(*colourPointer++);
 
 					if (colourPointer == colourView.end())
 						colourPointer -= colourView.size();
@@ -151,12 +166,59 @@
 					return ret;
 				}
 
+				const ChannelData::EnvelopePyramid & getEnvelope() const noexcept
+				{
+					return envelope;
+				}
+
+				/// <summary>
+				/// The amount of audio streams mixed into each sample
+				/// </summary>
+				static const std::size_t Inputs = 1;
+
+				/// <summary>
+				/// The count samples of each input starting at offset, relative to the same position as startFrom().
+				/// </summary>
+				std::array<RingSpan<AudioIt>, Inputs> audioSpans(cpl::ssize_t offset, std::size_t count) const noexcept
+				{
+					return {{ spanOf(audioView, offset - lag, count) }};
+				}
+
+				/// <summary>
+				/// The count colour codes starting at offset, relative to the same position as startFrom().
+				/// Empty if no colours are stored.
+				/// </summary>
+				RingSpan<ColourIt> colourSpan(cpl::ssize_t offset, std::size_t count) const noexcept
+				{
+					return spanOf(colourView, offset - lag, count);
+				}
+
+				/// <summary>
+				/// Turns the codes of colourSpan() into colours.
+				/// </summary>
+				const ChannelData::ColourDecoder & getColourDecoder() const noexcept
+				{
+					return decoder;
+				}
+
+				/// <summary>
+				/// Mixes one element of each input into a sample; works on scalars as well as vectors.
+				/// </summary>
+				template<typename V>
+				static V mix(const V * inputs, const V & /* half */) noexcept
+				{
+					return inputs[0];
+				}
+
 			private:
 
 				juce::Colour defaultKey;
 
 				ChannelData::AudioBuffer::ProxyView audioView;
 				ChannelData::ColourBuffer::ProxyView colourView;
+				const ChannelData::EnvelopePyramid & envelope;
+				const ChannelData::ColourDecoder & decoder;
+				const cpl::ssize_t lag;
 
 				AudioIt audioPointer {};
 				ColourIt colourPointer {};
@@ -167,18 +229,26 @@
 			{
 			public:
 
+				/// <summary>
+				/// Which of the two colours (and separated views) this evaluator draws with
+				/// </summary>
+				static const std::size_t Slot = ColourIndex;
+
 				MidSideEvaluatorBase(ChannelData & data)
 					: DefaultKey(data, ColourIndex)
-					, audioViewLeft(data.front.channels.at(0).audioData.createProxyView())
-					, audioViewRight(data.front.channels.at(1).audioData.createProxyView())
-					, colourView(data.front.midSideColour[ChannelIndex].createProxyView())
+					, audioViewLeft(data.getPublishedBuffer().channels.at(0).audioData.createProxyView())
+					, audioViewRight(data.getPublishedBuffer().channels.at(1).audioData.createProxyView())
+					, colourView(data.getPublishedBuffer().midSideColour[ChannelIndex].createProxyView())
+					, envelope(data.front.midSideEnvelope[ChannelIndex])
+					, decoder(data.colourDecoders[ColourIndex])
+					, lag(static_cast<cpl::ssize_t>(data.getPublishedLag()))
 				{
 
 				}
 
 				inline bool isWellDefined() const noexcept
 				{
-					return audioViewLeft.size() > 0 && audioViewRight.size() > 0 && audioViewLeft.size() == audioViewRight.size() && colourView.size() > 0;
+					return audioViewLeft.size() > 0 && audioViewRight.size() > 0 && audioViewLeft.size() == audioViewRight.size();
 				}
 
 				void startFrom(cpl::ssize_t offset)
@@ -188,7 +258,7 @@
 
 				void startFrom(cpl::ssize_t audioOffset, cpl::ssize_t colourOffset)
 				{
-					audioOffset += audioViewLeft.cursorPosition();
+					audioOffset += static_cast<cpl::ssize_t>(audioViewLeft.cursorPosition()) - lag;
 					audioPointerLeft = audioViewLeft.begin() + audioOffset;
 					audioPointerRight = audioViewRight.begin() + audioOffset;
 
@@ -205,7 +275,11 @@
 						audioPointerRight -= audioViewLeft.size();
 					}
 
-					colourPointer = colourView.begin() + colourView.cursorPosition() + colourOffset;
+					// colours are only stored when colouring by frequency
+					if (colourView.size() == 0)
+						return;
+
+					colourPointer = colourView.begin() + colourView.cursorPosition() + colourOffset - lag;
 
 					while (colourPointer < colourView.begin())
 						colourPointer += colourView.size();
@@ -217,7 +291,7 @@
 
 				inline void inc() noexcept
 				{
-					audioPointerLeft++, audioPointerRight++, colourPointer++;
+					audioPointerLeft++, audioPointerRight++;
 
 					if (audioPointerLeft == audioViewLeft.end())
 					{
@@ -225,7 +299,7 @@
 						audioPointerRight -= audioViewLeft.size();
 					}
 
-					if (colourPointer == colourView.end())
+					if (colourView.size() && ++colourPointer == colourView.end())
 						colourPointer -= colourView.size();
 				}
 
@@ -249,7 +323,7 @@
 
 				ColourT evaluateColour() const noexcept
 				{
-					return *colourPointer;
+					return colourView.size() ? decoder(*colourPointer) : getDefaultKey();
 				}
 
 				AudioT evaluateSampleInc() noexcept
@@ -269,7 +343,10 @@
 
 				ColourT evaluateColourInc() noexcept
 				{
-					auto ret = *colourPointer++;
+					if (!colourView.size())
+						return getDefaultKey();
+
+					auto ret = decoder(*colourPointer++);
 
 					if (colourPointer == colourView.end())
 						colourPointer -= colourView.size();
@@ -277,10 +354,58 @@
 					return ret;
 				}
 
+				const ChannelData::EnvelopePyramid & getEnvelope() const noexcept
+				{
+					return envelope;
+				}
+
+				/// <summary>
+				/// The amount of audio streams mixed into each sample
+				/// </summary>
+				static const std::size_t Inputs = 2;
+
+				/// <summary>
+				/// The count samples of each input starting at offset, relative to the same position as startFrom().
+				/// The inputs have the same size, so they wrap around at the same point.
+				/// </summary>
+				std::array<RingSpan<AudioIt>, Inputs> audioSpans(cpl::ssize_t offset, std::size_t count) const noexcept
+				{
+					return {{ spanOf(audioViewLeft, offset - lag, count), spanOf(audioViewRight, offset - lag, count) }};
+				}
+
+				/// <summary>
+				/// The count colour codes starting at offset, relative to the same position as startFrom().
+				/// Empty if no colours are stored.
+				/// </summary>
+				RingSpan<ColourIt> colourSpan(cpl::ssize_t offset, std::size_t count) const noexcept
+				{
+					return spanOf(colourView, offset - lag, count);
+				}
+
+				/// <summary>
+				/// Turns the codes of colourSpan() into colours.
+				/// </summary>
+				const ChannelData::ColourDecoder & getColourDecoder() const noexcept
+				{
+					return decoder;
+				}
+
+				/// <summary>
+				/// Mixes one element of each input into a sample; works on scalars as well as vectors.
+				/// </summary>
+				template<typename V>
+				static V mix(const V * inputs, const V & half) noexcept
+				{
+					return half * BinaryFunction()(inputs[0], inputs[1]);
+				}
+
 			private:
 
 				ChannelData::AudioBuffer::ProxyView audioViewLeft, audioViewRight;
 				ChannelData::ColourBuffer::ProxyView colourView;
+				const ChannelData::EnvelopePyramid & envelope;
+				const ChannelData::ColourDecoder & decoder;
+				const cpl::ssize_t lag;
 
 				AudioIt audioPointerLeft {}, audioPointerRight {};
 				ColourIt colourPointer{};
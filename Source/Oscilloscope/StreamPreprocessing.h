@@ -33,10 +33,115 @@
 
 	#include "Signalizer.h"
 	#include "Oscilloscope.h"
-	#include <queue>
+	#include <array>
+	#include <atomic>
+	#include <cmath>
+	#include <cpl/simd.h>
 
 	namespace Signalizer
 	{
+		namespace detail
+		{
+			/// <summary>
+			/// Packs the sign bit of each lane into an integer, lane 0 being the least significant bit.
+			/// </summary>
+			inline int signBits(float v) noexcept { return std::signbit(v) ? 1 : 0; }
+			inline int signBits(__m128 v) noexcept { return _mm_movemask_ps(v); }
+			inline int signBits(__m256 v) noexcept { return _mm256_movemask_ps(v); }
+		};
+
+		/// <summary>
+		/// Fixed capacity FIFO of trigger positions, that never allocates.
+		/// Written and read by the audio thread only; when full, the oldest position is discarded to make
+		/// room for the newest, unless it is being processed (see acquireFront()), in which case the one after it is.
+		/// The counters may be read from any thread.
+		/// </summary>
+		class TriggerQueue
+		{
+		public:
+
+			// must be a power of two
+			static const std::size_t Capacity = 1024;
+
+			void push(std::uint64_t position) noexcept
+			{
+				if (count == Capacity)
+				{
+					// keep the front in place if it is in use, by moving it over the second oldest
+					if (frontInUse)
+						ring[(start + 1) & (Capacity - 1)] = ring[start];
+
+					start = (start + 1) & (Capacity - 1);
+					count--;
+					dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+				}
+
+				ring[(start + count) & (Capacity - 1)] = position;
+				count++;
+
+				pushed.store(pushed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+				queued.store(count, std::memory_order_relaxed);
+			}
+
+			std::uint64_t front() const noexcept
+			{
+				return ring[start];
+			}
+
+			/// <summary>
+			/// Returns the front, and marks it as being processed so it survives overflows until it is popped.
+			/// </summary>
+			std::uint64_t acquireFront() noexcept
+			{
+				frontInUse = true;
+				return ring[start];
+			}
+
+			bool isFrontInUse() const noexcept
+			{
+				return frontInUse;
+			}
+
+			void pop() noexcept
+			{
+				frontInUse = false;
+
+				if (!count)
+					return;
+
+				start = (start + 1) & (Capacity - 1);
+				count--;
+				queued.store(count, std::memory_order_relaxed);
+			}
+
+			void clear() noexcept
+			{
+				frontInUse = false;
+				start = count = 0;
+				queued.store(count, std::memory_order_relaxed);
+			}
+
+			std::size_t size() const noexcept
+			{
+				return count;
+			}
+
+			/// <summary>
+			/// Thread safe diagnostics
+			/// </summary>
+			std::size_t getQueuedCount() const noexcept { return queued.load(std::memory_order_relaxed); }
+			std::uint64_t getPushedCount() const noexcept { return pushed.load(std::memory_order_relaxed); }
+			std::uint64_t getDroppedCount() const noexcept { return dropped.load(std::memory_order_relaxed); }
+
+		private:
+
+			std::array<std::uint64_t, Capacity> ring;
+			std::size_t start = 0, count = 0;
+			bool frontInUse = false;
+			std::atomic<std::size_t> queued{ 0 };
+			std::atomic<std::uint64_t> pushed{ 0 }, dropped{ 0 };
+		};
+
 		class PreprocessingTrigger
 		{
 		public:
@@ -52,6 +157,11 @@
 				threshold = valueThreshold;
 			}
 
+			const TriggerQueue & getTriggerQueue() const noexcept
+			{
+				return peaks;
+			}
+
 			void update(std::uint64_t currentSteadyClock)
 			{
 				steadyClock = currentSteadyClock;
@@ -59,7 +169,7 @@
 				{
 					windowChanged = false;
 
-					if (isWorkingOnPeak)
+					if (peaks.isFrontInUse())
 					{
 						peaks.pop();
 					}
@@ -69,9 +179,6 @@
 
 					bufferedSamples = currentPeak = oldPeak = 0;
 					frontOrigin = currentSteadyClock;
-
-					isWorkingOnPeak = false;
-
 				}
 			}
 
@@ -89,6 +196,7 @@
 
 				auto processIntoBackBuffer = [&](auto samples)
 				{
+					o.channelData.reserveBack(static_cast<std::size_t>(samples));
 					o.audioProcessing<ISA>(localPointers, numChannels, samples, o.channelData.back);
 					numSamples -= samples;
 					for (std::size_t c = 0; c < numChannels; ++c)
@@ -104,7 +212,7 @@
 
 				if (ceilingSize == 0 && peaks.size())
 				{
-					std::queue<std::uint64_t>().swap(peaks);
+					peaks.clear();
 				}
 
 				while (numSamples != 0)
@@ -114,12 +222,9 @@
 						processIntoBackBuffer(numSamples);
 						break;
 					}
-					else if (!isWorkingOnPeak)
+					else if (!peaks.isFrontInUse())
 					{
-
-						isWorkingOnPeak = true;
-
-						auto nextPeak = peaks.front();
+						auto nextPeak = peaks.acquireFront();
 						if (nextPeak >= steadyClock)
 						{
 							// select closest peak that has a full buffer
@@ -193,13 +298,12 @@
 
 						auto cappedSize = std::min<std::size_t>(bufferedSamples, std::ceil(amount + 1));
 						// 1
-						o.channelData.swapBuffers(cappedSize, -(cpl::ssize_t)bufferedSamples);
-						// 2
 						bufferedSamples -= std::min<std::uint64_t>(bufferedSamples, cappedSize);
+						// 2: the window is the oldest cappedSize buffered samples, so it ends where the remaining buffered samples begin
+						o.channelData.publishBack(cappedSize, static_cast<std::size_t>(bufferedSamples));
 						// 3
 						frontOrigin += cappedSize;
 						oldPeak = currentPeak;
-						isWorkingOnPeak = false;
 						peaks.pop();
 					}
 				}
@@ -219,8 +323,7 @@
 			std::uint64_t currentPeak, bufferedSamples;
 			std::uint64_t frontOrigin;
 			std::uint64_t steadyClock;
-			std::queue<std::uint64_t> peaks;
-			bool isWorkingOnPeak;
+			TriggerQueue peaks;
 
 
 		};
@@ -260,7 +363,7 @@
 			const std::uint64_t steadyClock;
 			std::uint64_t crossOrigin;
 			PreprocessingTrigger & outsideState;
-			std::queue<std::uint64_t> & peaks;
+			TriggerQueue & peaks;
 			bool isPeakHolding;
 			const double threshold, hysteresis;
 			double state;
@@ -312,6 +415,65 @@
 				count++;
 			}
 
+			/// <summary>
+			/// Equivalent to process() for each sample (up to rounding of the decay in the later lanes). While the signal is falling,
+			/// the state just decays, so it is evaluated a vector at a time against the decayed state, and only
+			/// vectors containing a rising sample run through the per-sample state machine.
+			/// </summary>
+			void processBlock(const AFloat * signal, std::size_t size) noexcept
+			{
+				using namespace cpl::simd;
+				typedef typename ISA::V V;
+
+				const std::size_t lanes = elements_of<V>::value;
+				const int allFalling = (1 << lanes) - 1;
+				const double decay = 0.9999;
+
+				alignas(32) AFloat powers[8], floors[8];
+				for (std::size_t k = 0; k < lanes; ++k)
+				{
+					powers[k] = static_cast<AFloat>(std::pow(decay, static_cast<double>(k)));
+					// the first lane is compared against the undecayed state, which process() doesn't floor
+					floors[k] = k == 0 ? 0 : static_cast<AFloat>(threshold * threshold);
+				}
+
+				const V vPowers = load<V>(powers);
+				const V vFloor = load<V>(floors);
+				const double blockDecay = std::pow(decay, static_cast<double>(lanes));
+
+				std::size_t i = 0;
+
+				for (; i + lanes <= size; i += lanes)
+				{
+					auto const vSample = loadu<V>(signal + i);
+					// the state before each lane, if every sample in the vector is falling
+					auto const vState = max(vFloor, set1<V>(static_cast<AFloat>(state)) * vPowers);
+
+					// lane 0 is additionally compared exactly like process() does
+					const double first = signal[i];
+
+					if (first * first - state < 0 && detail::signBits(vSample * vSample - vState) == allFalling)
+					{
+						if (isPeakHolding)
+						{
+							peaks.push(steadyClock + count - 1);
+							isPeakHolding = false;
+						}
+
+						state = std::max(threshold * threshold, state * blockDecay);
+						count += lanes;
+					}
+					else
+					{
+						for (std::size_t k = 0; k < lanes; ++k)
+							process(signal[i + k]);
+					}
+				}
+
+				for (; i < size; ++i)
+					process(signal[i]);
+			}
+
 		};
 
 		template<typename ISA>
@@ -348,6 +510,56 @@
 				count++;
 			}
 
+			/// <summary>
+			/// Equivalent to process() for each sample. Rising zero crossings (and samples over the threshold,
+			/// while waiting for one) are found a vector at a time through sign masks; only vectors containing
+			/// such candidates run through the per-sample state machine.
+			/// </summary>
+			void processBlock(const AFloat * signal, std::size_t size) noexcept
+			{
+				using namespace cpl::simd;
+				typedef typename ISA::V V;
+
+				if (!size)
+					return;
+
+				const std::size_t lanes = elements_of<V>::value;
+				const V vZero = zero<V>();
+				const V vThreshold = set1<V>(static_cast<AFloat>(threshold));
+
+				// the first sample needs the previous state
+				process(signal[0]);
+
+				std::size_t i = 1;
+
+				for (; i + lanes <= size; i += lanes)
+				{
+					auto const vPrevious = loadu<V>(signal + i - 1);
+					auto const vSample = loadu<V>(signal + i);
+
+					// sign bits set for: previous < 0 (adding zero clears negative zeros), sample > 0, sample > threshold
+					auto const negative = detail::signBits(vPrevious + vZero);
+					auto const positive = detail::signBits(vZero - vSample);
+					auto const above = detail::signBits(vThreshold - vSample);
+
+					auto const rising = negative & positive;
+
+					if (rising || (isPeakHolding && above))
+					{
+						for (std::size_t k = 0; k < lanes; ++k)
+							process(signal[i + k]);
+					}
+					else
+					{
+						state = signal[i + lanes - 1];
+						count += lanes;
+					}
+				}
+
+				for (; i < size; ++i)
+					process(signal[i]);
+			}
+
 		};
 
 	};
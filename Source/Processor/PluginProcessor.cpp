@@ -265,6 +265,17 @@ namespace Signalizer
 			}
 		}
 
+		auto & measurementStates = serializer.getContent("Measurements");
+		if (!measurementStates.isEmpty())
+		{
+			for (std::size_t i = 0; i < parameterMap.numSetsAndState(); ++i)
+			{
+				auto & serializedMeasurements = measurementStates.getContent(parameterMap.getSet(i)->getName());
+				if (!serializedMeasurements.isEmpty())
+					parameterMap.getState(i)->deserializeMeasurements(serializedMeasurements, serializedMeasurements.getLocalVersion());
+			}
+		}
+
 	}
 
 	void AudioProcessor::serialize(cpl::CSerializer & serializer, cpl::Version version)
@@ -322,6 +333,17 @@ namespace Signalizer
 		{
 			parameterState.getContent(parameterMap.getSet(i)->getName()) << *parameterMap.getState(i);
 		}
+
+		// kept apart from the parameters, which presets share
+		auto & measurementState = serializer.getContent("Measurements");
+		measurementState.clear();
+		measurementState.setMasterVersion(cpl::programInfo.version);
+
+		for (std::size_t i = 0; i < parameterMap.numSetsAndState(); ++i)
+		{
+			auto & measurements = measurementState.getContent(parameterMap.getSet(i)->getName());
+			parameterMap.getState(i)->serializeMeasurements(measurements, cpl::programInfo.version);
+		}
 	}
 
 
@@ -4,5 +4,7 @@
 #include "version.h"
 #include "Common/CommonSignalizer.h"
 #include "Common/SharedBehaviour.h"
+#include "Common/LineStream.h"
+#include "Common/PhosphorImage.h"
 
 #endif
\ No newline at end of file
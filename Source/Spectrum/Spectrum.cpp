@@ -35,6 +35,7 @@
 #include <cpl/simd.h>
 #include <cpl/LexicalConversion.h>
 #include <array>
+#include <limits>
 
 namespace Signalizer
 {
@@ -349,10 +350,18 @@ namespace Signalizer
 	{
 		using namespace cpl;
 		// TODO: create parameter indices and turn into switch statement
-		if (param == &content->windowSize.parameter)
+		if (param == &content->windowSize.parameter || param == &content->autoWindowSize.parameter)
 		{
-			state.newWindowSize.store(cpl::Math::round<std::size_t>(content->windowSize.getTransformedValue()), std::memory_order_release);
-			flags.initiateWindowResize = true;
+			if (content->autoWindowSize.getTransformedValue() > 0.5)
+			{
+				// the window size is only an upper limit now, the actual size depends on the view.
+				flags.planWindowSize = true;
+			}
+			else
+			{
+				state.newWindowSize.store(cpl::Math::round<std::size_t>(content->windowSize.getTransformedValue()), std::memory_order_release);
+				flags.initiateWindowResize = true;
+			}
 		}
 		if (param == &content->viewScaling.param.parameter || param == &content->viewLeft.parameter || param == &content->viewRight.parameter)
 		{
@@ -378,6 +387,7 @@ namespace Signalizer
 		else if (param == &content->algorithm.param.parameter)
 		{
 			flags.resetStateBuffers = true;
+			flags.planWindowSize = true;
 		}
 		else if (param == &content->dspWin.alpha || param == &content->dspWin.beta || param == &content->dspWin.symmetry || param == &content->dspWin.type)
 		{
@@ -433,6 +443,9 @@ namespace Signalizer
 		state.frequencyTrackingGraph = cpl::enum_cast<SpectrumContent::LineGraphs>(content->frequencyTracker.param.getTransformedValue() + SpectrumContent::LineGraphs::None);
 		state.dspWindow.store(content->dspWin.getWindowType(), std::memory_order_release);
 		state.binPolation = content->binInterpolation.param.getAsTEnum<SpectrumContent::BinInterpolation>();
+		state.octaveBandwidth = SpectrumContent::getOctaveBandwidth(content->octaveSmoothing.param.getAsTEnum<SpectrumContent::OctaveSmoothing>());
+		state.transferAveraging = content->transferAveraging.getTransformedValue() * 0.001;
+		state.autoWindowSize = content->autoWindowSize.getTransformedValue() > 0.5;
 		state.colourGrid = content->gridColour.getAsJuceColour();
 		state.colourBackground = content->backgroundColour.getAsJuceColour();
 		state.colourTracker = content->trackerColour.getAsJuceColour();
@@ -470,6 +483,12 @@ namespace Signalizer
 			{
 				complexFrequencyGraph.clear();
 			}
+			if (newconf == SpectrumChannels::Transfer)
+			{
+				audioLock.acquire(audioResource);
+				binCrossSpectrum.zero();
+				resonatorCrossSpectrum.zero();
+			}
 			flags.viewChanged = true;
 		}
 
@@ -492,6 +511,14 @@ namespace Signalizer
 			flags.resetStateBuffers = true;
 		}
 
+		// accumulation may allocate, so it is only done for line graphs (where transforms run on this thread)
+		state.longTermAverage = content->longTermAverage.getTransformedValue() > 0.5 && state.displayMode == SpectrumContent::DisplayMode::LineGraph;
+
+		if (flags.resetLongTermAverage.cas())
+		{
+			content->ltas.reset();
+		}
+
 		std::size_t axisPoints = state.displayMode == SpectrumContent::DisplayMode::LineGraph ? getWidth() : getHeight();
 
 		if (axisPoints != state.axisPoints)
@@ -542,6 +569,8 @@ namespace Signalizer
 			// some cases it is nice to have an extra entry (see handling of
 			// separating real and imaginary transforms)
 			audioMemory.resize((bufSize + 1) * sizeof(std::complex<double>));
+			smoothingSums.resize(bufSize + 1);
+			binCrossSpectrum.resize(bufSize / 2 + 1);
 			windowKernel.resize(bufSize);
 			flags.windowKernelChange = true;
 		}
@@ -563,6 +592,9 @@ namespace Signalizer
 
 			slopeMap.resize(numFilters);
 			workingMemory.resize(numFilters * 2 * sizeof(std::complex<double>));
+			resonatorSnapshot.resize(numFilters * 2);
+			resonatorCrossSpectrum.resize(numFilters);
+			transferPhase.resize(numFilters);
 
 			columnUpdate.resize(getHeight());
 			// avoid doing it twice.
@@ -699,6 +731,24 @@ namespace Signalizer
 			}
 			remapResonator = true;
 			flags.slopeMapChanged = true;
+			flags.planWindowSize = true;
+		}
+
+		auto const windowCeiling = cpl::Math::round<std::size_t>(content->windowSize.getTransformedValue());
+		// a new window size changes the bins, which restarts the long-term average. so while it runs,
+		// view changes are left pending and only a lowered ceiling is followed.
+		auto const holdWindowSize = state.longTermAverage && state.newWindowSize.load(std::memory_order_acquire) <= windowCeiling;
+
+		if (state.autoWindowSize && !holdWindowSize && flags.planWindowSize.cas())
+		{
+			auto const ceiling = windowCeiling;
+			auto const current = state.newWindowSize.load(std::memory_order_acquire);
+			// the resonators derive their Q from the window size, so only the FFT follows the view.
+			auto const planned = state.algo.load(std::memory_order_acquire) == SpectrumContent::TransformAlgorithm::FFT
+				? planWindowSize(current, ceiling, sampleRate) : ceiling;
+
+			if (planned != current)
+				setWindowSize(planned);
 		}
 
 		if (flags.slopeMapChanged.cas())
@@ -746,6 +796,9 @@ namespace Signalizer
 				lineGraphs[i].zero();
 			std::memset(audioMemory.data(), 0, audioMemory.size() /* * sizeof(char) */);
 			std::memset(workingMemory.data(), 0, workingMemory.size() /* * sizeof(char) */);
+			resonatorSnapshot.resize(numFilters * 2);
+			binCrossSpectrum.zero();
+			resonatorCrossSpectrum.zero();
 		}
 
 		// reset all flags through value-initialization
@@ -758,6 +811,38 @@ namespace Signalizer
 		return n;
 	}
 
+	std::size_t Spectrum::planWindowSize(std::size_t current, std::size_t ceiling, double sampleRate) const noexcept
+	{
+		// arbitrary floor, below this the window functions degenerate anyway.
+		const std::size_t minimumSize = 64;
+
+		double finestBandwidth = std::numeric_limits<double>::max();
+
+		for (std::size_t i = 1; i < mappedFrequencies.size(); ++i)
+		{
+			auto const bandwidth = std::abs(static_cast<double>(mappedFrequencies[i]) - mappedFrequencies[i - 1]);
+			if (bandwidth > 0)
+				finestBandwidth = std::min(finestBandwidth, bandwidth);
+		}
+
+		if (sampleRate <= 0 || finestBandwidth == std::numeric_limits<double>::max())
+			return current;
+
+		ceiling = std::max(minimumSize, ceiling);
+
+		// bin spacing is sampleRate / N, for all channel configurations.
+		auto const wanted = std::min<double>(ceiling, std::ceil(sampleRate / finestBandwidth));
+		auto const needed = std::min(ceiling, std::max(minimumSize, cpl::Math::nextPow2Inc(static_cast<std::size_t>(wanted))));
+
+		if (needed > current || current > ceiling)
+			return needed;
+
+		if (needed * 4 <= current)
+			return std::min(ceiling, needed * 2);
+
+		return current;
+	}
+
 	void Spectrum::setWindowSize(std::size_t size)
 	{
 		state.newWindowSize.store(getValidWindowSize(size), std::memory_order_release);
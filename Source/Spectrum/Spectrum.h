@@ -182,6 +182,23 @@
 			/// </summary>
 			std::size_t mapToLinearSpace();
 
+			/// <summary>
+			/// Accumulates the magnitude bins into the long-term average, weighted by the amount of audio that arrived
+			/// since the last accumulation, and replaces them with the average so the rest of the mapping displays it.
+			/// Nothing is accumulated if no new audio arrived. Bins must be normalized (see mapToLinearSpace).
+			/// Needs exclusive access to audioResource.
+			/// </summary>
+			void applyLongTermAverage(std::complex<fftType> * bins, std::size_t count);
+
+			/// <summary>
+			/// Fractional-octave smoothing of a linear FFT magnitude spectrum, done in O(bins + points) through prefix sums of power.
+			/// Channel bins are read as bins[k * stride] for k in [0, numBins), and each output pixel is set to the
+			/// RMS of the bins inside state.octaveBandwidth octaves around its mapped frequency, times scale.
+			/// If mirrored, bins above numBins / 2 are treated as negative frequencies (see SpectrumChannels::Complex).
+			/// Needs exclusive access to audioResource.
+			/// </summary>
+			void smoothFractionalOctaves(const std::complex<fftType> * bins, std::ptrdiff_t stride, std::size_t numBins, std::complex<fftType> * output, double freqToBin, double scale, bool mirrored);
+
 			/// <summary>
 			/// Runs the transform (of any kind) results through potential post filters and other features, before displaying it.
 			/// The transform will be rendered into filterResults after this.
@@ -191,7 +208,7 @@
 
 			/// <summary>
 			/// Post processes the transform that will be interpreted according to what's selected.
-			/// Needs exclusive access to audioResource.
+			/// Needs exclusive access to audioResource, except for resonator line graphs that read the published resonatorSnapshot.
 			/// </summary>
 			void postProcessStdTransform();
 
@@ -241,6 +258,14 @@
 
 			std::size_t getValidWindowSize(std::size_t in) const noexcept;
 
+			/// <summary>
+			/// Returns the smallest power-of-two window whose bin spacing resolves the finest pixel bandwidth
+			/// in mappedFrequencies, limited by ceiling. To avoid reallocating on every small zoom, the window
+			/// grows immediately but only shrinks once the view needs less than a quarter of the current size.
+			/// Returns current if no change is needed.
+			/// </summary>
+			std::size_t planWindowSize(std::size_t current, std::size_t ceiling, double sampleRate) const noexcept;
+
 			/// <summary>
 			/// Returns the number of needed channels required to process the current
 			/// channel configuration.
@@ -315,6 +340,10 @@
 			/// for mode = phase
 			/// 	newVals[n * 2 + 0] = mag
 			/// 	newVals[n * 2 + 1] = phase cancellation(with 1 being totally cancelled)
+			/// for mode = transfer
+			/// 	newVals[n * 2 + 0] = transfer function magnitude
+			/// 	newVals[n * 2 + 1] = magnitude-squared coherence
+			/// 	newVals[n * 2 + size * 2] = transfer function phase (radians)
 			/// </summary>
 			template<class V2>
 				void mapAndTransformDFTFilters(SpectrumChannels type, const V2 & newVals, std::size_t size, double lowerFraction, double upperFraction, float clip);
@@ -381,6 +410,21 @@
 			template<typename ISA, class Vector>
 				std::size_t copyResonatorStateInto(Vector & output);
 
+			/// <summary>
+			/// Copies the windowed resonator state into the output, formatted for postProcessTransform()
+			/// according to the channel configuration (see mapToLinearSpace()).
+			/// elapsedSeconds is the time since the last call, used for running averages.
+			/// Needs exclusive access to audioResource.
+			/// </summary>
+			void formatResonatorState(std::complex<fpoint> * output, double elapsedSeconds);
+
+			/// <summary>
+			/// Publishes the current resonator state into resonatorSnapshot at the end of an audio block,
+			/// if the previous one was consumed or is getting old.
+			/// Needs exclusive access to audioResource.
+			/// </summary>
+			void publishResonatorState(std::size_t numSamples);
+
 			void drawFrequencyTracking(juce::Graphics & g);
 
 			/// <summary>
@@ -409,6 +453,26 @@
 				/// </summary>
 				SpectrumContent::BinInterpolation binPolation;
 
+				/// <summary>
+				/// Full bandwidth in octaves of the smoothing applied to FFT spectrums, zero if disabled.
+				/// </summary>
+				double octaveBandwidth;
+
+				/// <summary>
+				/// Whether FFT line graphs display the long-term average spectrum.
+				/// </summary>
+				bool longTermAverage;
+
+				/// <summary>
+				/// Time constant in seconds of the cross-spectrum averages for SpectrumChannels::Transfer.
+				/// </summary>
+				double transferAveraging;
+
+				/// <summary>
+				/// Whether the window size follows the zoom level, see planWindowSize().
+				/// </summary>
+				bool autoWindowSize;
+
 				/// <summary>
 				/// Is the spectrum a horizontal device (line graph)
 				/// or a vertical coloured spectrum?
@@ -551,6 +615,14 @@
 					/// Set this to recalculate the slopes
 					/// </summary>
 					slopeMapChanged,
+					/// <summary>
+					/// Restarts the long-term average spectrum
+					/// </summary>
+					resetLongTermAverage,
+					/// <summary>
+					/// Re-evaluates the automatic window size against the current view
+					/// </summary>
+					planWindowSize,
 					mouseMove;
 			} flags;
 
@@ -560,6 +632,11 @@
 			const SharedBehaviour & globalBehaviour;
 			juce::MouseCursor displayCursor;
 			cpl::OpenGLRendering::COpenGLImage oglImage;
+			/// <summary>
+			/// The line graphs, streamed to the line shader
+			/// </summary>
+			LineGeometry lineGeometry;
+			LineStream lineStream;
 			cpl::special::FrequencyAxis frequencyGraph, complexFrequencyGraph;
 			cpl::special::DBMeterAxis dbGraph;
 			cpl::CBoxFilter<double, 60> avgFps;
@@ -640,6 +717,120 @@
 					std::memset(results.data(), 0, results.size() * sizeof(UComplex));
 				}
 			};
+			/// <summary>
+			/// Lock-free triple buffer of formatted resonator frames, written by the audio thread
+			/// and read by the rendering thread without either blocking the other.
+			/// The writer and reader each own a buffer, and exchange it with the shared one.
+			/// </summary>
+			class ResonatorSnapshot
+			{
+			public:
+
+				typedef cpl::aligned_vector<UComplex, 32> Frame;
+
+				/// <summary>
+				/// Not thread safe, neither side may be active.
+				/// </summary>
+				void resize(std::size_t n)
+				{
+					for (auto & b : buffers)
+						b.assign(n, UComplex());
+
+					writer = 0;
+					reader = 1;
+					shared.store(2, std::memory_order_release);
+					samplesSincePublish = 0;
+				}
+
+				/// <summary>
+				/// Whether the last published frame has yet to be acquired by the reader.
+				/// </summary>
+				bool isPending() const noexcept
+				{
+					return (shared.load(std::memory_order_acquire) & kPendingBit) != 0;
+				}
+
+				Frame & getWriteBuffer() noexcept
+				{
+					return buffers[writer];
+				}
+
+				void publish() noexcept
+				{
+					writer = shared.exchange(writer | kPendingBit, std::memory_order_acq_rel) & kIndexMask;
+					samplesSincePublish = 0;
+				}
+
+				/// <summary>
+				/// Returns the most recently published frame. The frame stays valid until the next call.
+				/// </summary>
+				const Frame & acquire() noexcept
+				{
+					if (isPending())
+						reader = shared.exchange(reader, std::memory_order_acq_rel) & kIndexMask;
+
+					return buffers[reader];
+				}
+
+				/// <summary>
+				/// Audio processed since the last publication, only touched by the writer.
+				/// </summary>
+				std::size_t samplesSincePublish = 0;
+
+			private:
+
+				static const int kPendingBit = 4, kIndexMask = 3;
+
+				Frame buffers[3];
+				int writer = 0, reader = 1;
+				std::atomic<int> shared { 2 };
+			};
+
+			/// <summary>
+			/// Exponentially weighted Welch sums of the auto- and cross-spectra of a reference (x) and a measurement (y),
+			/// used for SpectrumChannels::Transfer.
+			/// </summary>
+			struct WelchCrossSpectrum
+			{
+				cpl::aligned_vector<double, 32> xx, yy;
+				cpl::aligned_vector<std::complex<double>, 32> xy;
+
+				void resize(std::size_t n)
+				{
+					xx.assign(n, 0.0); yy.assign(n, 0.0); xy.assign(n, std::complex<double>());
+				}
+
+				void zero()
+				{
+					resize(xx.size());
+				}
+
+				void accumulate(std::size_t k, std::complex<double> x, std::complex<double> y, double pole) noexcept
+				{
+					const double gain = 1 - pole;
+					xx[k] = pole * xx[k] + gain * std::norm(x);
+					yy[k] = pole * yy[k] + gain * std::norm(y);
+					xy[k] = pole * xy[k] + gain * (std::conj(x) * y);
+				}
+
+				/// <summary>
+				/// Estimates the transfer function (H1) and the magnitude-squared coherence over the cells [begin, end).
+				/// </summary>
+				void estimate(std::size_t begin, std::size_t end, std::complex<double> & transfer, double & coherence) const noexcept
+				{
+					double sxx = 0, syy = 0;
+					std::complex<double> sxy;
+
+					for (std::size_t k = begin; k < end; ++k)
+					{
+						sxx += xx[k]; syy += yy[k]; sxy += xy[k];
+					}
+
+					transfer = sxx > 0 ? sxy / sxx : std::complex<double>();
+					coherence = sxx > 0 && syy > 0 ? std::norm(sxy) / (sxx * syy) : 0;
+				}
+			};
+
 			// dsp objects
 			std::array<LineGraphDesc, SpectrumContent::LineGraphs::LineEnd> lineGraphs;
 			/// <summary>
@@ -647,6 +838,20 @@
 			/// </summary>
 			cpl::dsp::CComplexResonator<fpoint, 2> cresonator;
 			/// <summary>
+			/// Resonator outputs published for line graphs, see publishResonatorState().
+			/// Resized in handleFlagUpdates
+			/// </summary>
+			ResonatorSnapshot resonatorSnapshot;
+			/// <summary>
+			/// Welch sums for the transfer configuration, per linear FFT bin (resized with audioMemory)
+			/// and per resonator (resized with the display).
+			/// </summary>
+			WelchCrossSpectrum binCrossSpectrum, resonatorCrossSpectrum;
+			/// <summary>
+			/// The phase in radians of the transfer function for each pixel, see SpectrumChannels::Transfer.
+			/// </summary>
+			cpl::aligned_vector<fpoint, 32> transferPhase;
+			/// <summary>
 			/// An array, of numFilters size, with each element being the frequency for the filter of
 			/// the corresponding logical display pixel unit.
 			/// </summary>
@@ -736,6 +941,15 @@
 
 			cpl::aligned_vector<fpoint, 32> slopeMap;
 			/// <summary>
+			/// Prefix sums of bin powers for fractional-octave smoothing. Resized together with audioMemory.
+			/// </summary>
+			cpl::aligned_vector<double, 32> smoothingSums;
+			/// <summary>
+			/// Samples received by audioProcessing, and the value of it at the last long-term average accumulation.
+			/// </summary>
+			std::atomic<std::uint64_t> receivedSamples { 0 };
+			std::uint64_t averagedSamples = 0;
+			/// <summary>
 			/// All audio processing not done in the audio thread (not real-time, async audio) must acquire this lock.
 			/// Notice, you must always acquire this lock before accessing the audio buffers (should you intend to).
 			/// </summary>
@@ -67,6 +67,7 @@ namespace Signalizer
 	void Spectrum::resetState()
 	{
 		flags.resetStateBuffers = true;
+		flags.resetLongTermAverage = true;
 	}
 
 
@@ -269,6 +270,7 @@ namespace Signalizer
 				case SpectrumChannels::Phase:
 				case SpectrumChannels::Separate:
 				case SpectrumChannels::Complex:
+				case SpectrumChannels::Transfer:
 				{
 					for (std::size_t indice = 0; indice < Stream::bufferIndices; ++indice)
 					{
@@ -519,6 +521,7 @@ namespace Signalizer
 				case SpectrumChannels::Phase:
 				case SpectrumChannels::Separate:
 				case SpectrumChannels::Complex:
+				case SpectrumChannels::Transfer:
 				{
 
 					for (std::size_t indice = 0; indice < Stream::bufferIndices; ++indice)
@@ -727,6 +730,29 @@ namespace Signalizer
 				}
 				break;
 			}
+			case SpectrumChannels::Transfer:
+			{
+				for (cpl::Types::fint_t i = 0; i < size; ++i)
+				{
+					auto gain = newVals[i * 2];
+					auto coherence = newVals[i * 2 + 1];
+					transferPhase[i] = (fpoint)newVals[i * 2 + size * 2];
+
+					// the transfer function is already averaged, and is not sloped
+					auto deltaX = gain * minFracRecip;
+					auto result = deltaX > 0 ? std::log(deltaX) * deltaYRecip : lowerClip;
+
+					for (std::size_t k = 0; k < lineGraphs.size(); ++k)
+					{
+						lineGraphs[k].states[i].magnitude = (fpoint)gain;
+						lineGraphs[k].states[i].phase = (fpoint)coherence;
+						lineGraphs[k].results[i].magnitude = (fpoint)result;
+						// coherence is displayed linearly over the full height
+						lineGraphs[k].results[i].phase = (fpoint)coherence;
+					}
+				}
+				break;
+			}
 			};
 
 
@@ -743,9 +769,20 @@ namespace Signalizer
 	void Spectrum::postProcessStdTransform()
 	{
 		if (state.algo.load(std::memory_order_acquire) == SpectrumContent::TransformAlgorithm::FFT)
+		{
 			postProcessTransform(getWorkingMemory<fftType>(), getNumFilters());
+		}
+		else if (state.displayMode == SpectrumContent::DisplayMode::LineGraph)
+		{
+			// the latest frame published by the audio thread, see publishResonatorState()
+			auto & frame = resonatorSnapshot.acquire();
+			if (frame.size() >= (std::size_t)getNumFilters())
+				postProcessTransform(reinterpret_cast<const fpoint *>(frame.data()), getNumFilters());
+		}
 		else
+		{
 			postProcessTransform(getWorkingMemory<fpoint>(), getNumFilters());
+		}
 	}
 
 	std::size_t Spectrum::mapToLinearSpace()
@@ -811,6 +848,9 @@ namespace Signalizer
 					csf[i] = std::abs(csf[i]);
 				}
 
+				if (state.longTermAverage)
+					applyLongTermAverage(csf, numBins + 1);
+
 				double fftBandwidth = 1.0 / numBins;
 				//double pxlBandwidth = 1.0 / numPoints;
 				cpl::Types::fint_t x = 0;
@@ -890,6 +930,9 @@ namespace Signalizer
 					oldBin = bin;
 				}
 
+				if (state.octaveBandwidth > 0)
+					smoothFractionalOctaves(csf, 1, numBins + 1, csp, freqToBin, invSize, false);
+
 				break;
 			}
 			case SpectrumChannels::Phase:
@@ -1120,6 +1163,9 @@ namespace Signalizer
 					csf[i] = std::abs(csf[i]);
 				}
 
+				if (state.longTermAverage)
+					applyLongTermAverage(csf, N + 1);
+
 				// The index of the transform, where the bandwidth is higher than mapped pixels (so no more interpolation is needed)
 				// TODO: This can be calculated from view mapping scale and N pixels.
 				std::size_t bandWidthBreakingPoint = numPoints - 1;
@@ -1234,6 +1280,13 @@ namespace Signalizer
 					csp[numFilters + x] = invSize * csf[maxRBin];
 					oldBin = bin;
 				}
+
+				if (state.octaveBandwidth > 0)
+				{
+					// right channel is stored in reverse order from csf[N]
+					smoothFractionalOctaves(csf, 1, numBins, csp, freqToBin, invSize, false);
+					smoothFractionalOctaves(csf + N, -1, numBins, csp + numFilters, freqToBin, invSize, false);
+				}
 			}
 			break;
 			case SpectrumChannels::Complex:
@@ -1253,6 +1306,9 @@ namespace Signalizer
 					csf[i] = std::abs(csf[i]);
 				}
 
+				if (state.longTermAverage)
+					applyLongTermAverage(csf, N);
+
 				while(x < numPoints)
 				{
 
@@ -1346,52 +1402,214 @@ namespace Signalizer
 						oldBin = bin;
 					}
 				}
+
+				if (state.octaveBandwidth > 0)
+					smoothFractionalOctaves(csf, 1, N, csp, freqToBin, invSize, true);
 			}
 
 			break;
+			case SpectrumChannels::Transfer:
+			{
+				// two-for-one pass, first channel is 0... N/2 -1, second is N/2 .. N -1
+				cpl::dsp::separateTransformsIPL(csf, N);
+
+				// fix up DC bins (see previous function documentation), scaling otherwise cancels out in the estimates
+				csf[N] = csf[0].imag() * 0.5;
+				csf[0] = csf[0].real() * 0.5;
+
+				// running Welch sums. line graphs are transformed once per rendered frame, while the colour spectrum
+				// is transformed on the audio thread once per blob
+				auto const timeStep = state.displayMode == SpectrumContent::DisplayMode::ColourSpectrum
+					? getBlobSamples() / getSampleRate()
+					: openGLDeltaTime();
+				auto const pole = state.transferAveraging > 0 ? std::exp(-timeStep / state.transferAveraging) : 0.0;
+
+				for (std::size_t k = 0; k < numBins; ++k)
+				{
+					binCrossSpectrum.accumulate(k, csf[k], csf[N - k], pole);
+				}
+
+				auto const binAt = [&](double frequency) { return Math::confineTo((std::size_t)(frequency * freqToBin + 0.5), 0, numBins - 1); };
+
+				// sums the bins between the midpoints of neighbouring pixels, or uses the nearest bin when pixels are narrower
+				for (std::size_t x = 0; x < numPoints; ++x)
+				{
+					auto const lowerFrequency = x > 0 ? 0.5 * (mappedFrequencies[x - 1] + mappedFrequencies[x]) : mappedFrequencies[x];
+					auto const upperFrequency = x + 1 < numPoints ? 0.5 * (mappedFrequencies[x] + mappedFrequencies[x + 1]) : mappedFrequencies[x];
+					auto const begin = binAt(lowerFrequency);
+					auto const end = std::max<std::size_t>(begin + 1, binAt(upperFrequency));
+
+					std::complex<double> transfer;
+					double coherence;
+					binCrossSpectrum.estimate(begin, end, transfer, coherence);
+
+					wsp[x * 2] = std::abs(transfer);
+					wsp[x * 2 + 1] = coherence;
+					wsp[numFilters * 2 + x * 2] = std::arg(transfer);
+				}
+
+				break;
+			}
 			}
 			break;
 		}
 		case SpectrumContent::TransformAlgorithm::RSNT:
 		{
 
-			std::complex<float> * wsp = getWorkingMemory<std::complex<float>>();
-			std::size_t filtersPerChannel;
+			formatResonatorState(getWorkingMemory<std::complex<fpoint>>(), getBlobSamples() / getSampleRate());
+		}
+		break;
+		}
+
+		return numFilters;
+	}
+
+	void Spectrum::formatResonatorState(std::complex<fpoint> * wsp, double elapsedSeconds)
+	{
+		using namespace cpl;
+
+		std::size_t filtersPerChannel;
+		{
+			// locking, to ensure the amount of resonators doesn't change inbetween.
+			cpl::CMutex lock(cresonator);
+			filtersPerChannel = copyResonatorStateInto<fpoint>(wsp) / getStateConfigurationChannels();
+		}
+
+
+		switch (state.configuration)
+		{
+		case SpectrumChannels::Phase:
+		{
+			for (std::size_t x = 0; x < filtersPerChannel; ++x)
 			{
-				// locking, to ensure the amount of resonators doesn't change inbetween.
-				cpl::CMutex lock(cresonator);
-				filtersPerChannel = copyResonatorStateInto<fpoint>(wsp) / getStateConfigurationChannels();
+
+				auto iLeft = wsp[x];
+				auto iRight = wsp[x + filtersPerChannel];
+
+				auto cancellation = std::sqrt(Math::square(iLeft + iRight));
+				auto mid = std::abs(iLeft) + std::abs(iRight);
+
+
+				wsp[x] = std::complex<float>(mid, fpoint(1) - (mid > 0 ? (cancellation / mid) : 0));
+
 			}
 
+			break;
+		}
+		case SpectrumChannels::Transfer:
+		{
+			auto const pole = state.transferAveraging > 0 ? std::exp(-elapsedSeconds / state.transferAveraging) : 0.0;
+			auto const filters = std::min(filtersPerChannel, resonatorCrossSpectrum.xx.size());
 
-			switch (state.configuration)
-			{
-			case SpectrumChannels::Phase:
+			for (std::size_t x = 0; x < filters; ++x)
 			{
-				for (std::size_t x = 0; x < filtersPerChannel; ++x)
-				{
+				resonatorCrossSpectrum.accumulate(x, wsp[x], wsp[x + filtersPerChannel], pole);
+
+				std::complex<double> transfer;
+				double coherence;
+				resonatorCrossSpectrum.estimate(x, x + 1, transfer, coherence);
+
+				wsp[x] = std::complex<float>(static_cast<fpoint>(std::abs(transfer)), static_cast<fpoint>(coherence));
+				wsp[x + filtersPerChannel] = std::complex<float>(static_cast<fpoint>(std::arg(transfer)), 0);
+			}
 
-					auto iLeft = wsp[x];
-					auto iRight = wsp[x + filtersPerChannel];
+			break;
+		}
+		// rest of cases does not need any handling
+		}
+	}
 
-					auto cancellation = std::sqrt(Math::square(iLeft + iRight));
-					auto mid = std::abs(iLeft) + std::abs(iRight);
+	void Spectrum::publishResonatorState(std::size_t numSamples)
+	{
+		CPL_RUNTIME_ASSERTION(audioResource.refCountForThisThread() > 0 && "Thread processing audio transforms doesn't own lock");
 
+		resonatorSnapshot.samplesSincePublish += numSamples;
 
-					wsp[x] = std::complex<float>(mid, fpoint(1) - (mid > 0 ? (cancellation / mid) : 0));
+		// only do the work if the reader took the last frame, or it is getting noticeably old (~8 ms)
+		if (resonatorSnapshot.isPending() && resonatorSnapshot.samplesSincePublish < getSampleRate() / 120)
+			return;
 
-				}
+		auto & frame = resonatorSnapshot.getWriteBuffer();
 
-				break;
+		if (frame.size() < cresonator.getNumFilters() * getStateConfigurationChannels())
+			return;
+
+		formatResonatorState(reinterpret_cast<std::complex<fpoint> *>(frame.data()), resonatorSnapshot.samplesSincePublish / getSampleRate());
+		resonatorSnapshot.publish();
+	}
+
+	void Spectrum::applyLongTermAverage(std::complex<fftType> * bins, std::size_t count)
+	{
+		// different configurations place different channels in the same bins
+		auto const layout = static_cast<std::uint64_t>(state.configuration);
+		auto const sampleRate = getSampleRate();
+
+		// frames are rendered more often than the window moves, so weight each transform by the new audio it contains.
+		// this keeps the average independent of the frame rate, and stops it from accumulating while the audio is stopped.
+		auto const received = receivedSamples.load(std::memory_order_acquire);
+		auto const newSamples = std::min<std::uint64_t>(received - averagedSamples, getWindowSize());
+		averagedSamples = received;
+
+		if (newSamples > 0)
+			content->ltas.accumulate(bins, count, sampleRate, layout, static_cast<double>(newSamples));
+
+		content->ltas.snapshotInto(bins, count, sampleRate, layout);
+	}
+
+	void Spectrum::smoothFractionalOctaves(const std::complex<fftType> * bins, std::ptrdiff_t stride, std::size_t numBins, std::complex<fftType> * output, double freqToBin, double scale, bool mirrored)
+	{
+		if (numBins == 0 || smoothingSums.size() < numBins + 1)
+			return;
+
+		double * sums = smoothingSums.data();
+
+		sums[0] = 0;
+		for (std::size_t k = 0; k < numBins; ++k)
+			sums[k + 1] = sums[k] + std::norm(bins[static_cast<std::ptrdiff_t>(k) * stride]);
+
+		// integral of the piecewise constant power spectrum from -0.5 to the fractional bin position,
+		// where bin k spans [k - 0.5, k + 0.5)
+		auto const integrate = [&](double position)
+		{
+			auto const edge = cpl::Math::confineTo(position + 0.5, 0.0, static_cast<double>(numBins));
+			auto const k = static_cast<std::size_t>(edge);
+			if (k >= numBins)
+				return sums[numBins];
+			return sums[k] + (edge - k) * (sums[k + 1] - sums[k]);
+		};
+
+		auto const halfBandRatio = std::exp2(0.5 * state.octaveBandwidth);
+		auto const period = static_cast<double>(numBins);
+		auto const numPoints = getAxisPoints();
+
+		for (std::size_t x = 0; x < numPoints; ++x)
+		{
+			auto const center = mappedFrequencies[x] * freqToBin;
+			double lower, upper;
+
+			if (mirrored && center > period * 0.5)
+			{
+				// negative frequencies: the band is relative to the distance from DC at the other end
+				auto const distance = period - center;
+				lower = period - distance * halfBandRatio;
+				upper = period - distance / halfBandRatio;
 			}
-			// rest of cases does not need any handling
+			else
+			{
+				lower = center / halfBandRatio;
+				upper = center * halfBandRatio;
 			}
 
-		}
-		break;
-		}
+			// bands narrower than the fft resolution degrade to a single (interpolated) bin
+			if (upper - lower < 1)
+			{
+				lower = center - 0.5;
+				upper = center + 0.5;
+			}
 
-		return numFilters;
+			auto const power = std::max(0.0, integrate(upper) - integrate(lower)) / (upper - lower);
+			output[x] = scale * std::sqrt(power);
+		}
 	}
 
 
@@ -1494,6 +1712,8 @@ namespace Signalizer
 		{
 			cpl::CMutex audioLock;
 
+			receivedSamples.fetch_add(numSamples, std::memory_order_release);
+
 			if (state.displayMode == SpectrumContent::DisplayMode::ColourSpectrum)
 			{
 
@@ -1558,6 +1778,7 @@ namespace Signalizer
 			{
 				audioLock.acquire(audioResource);
 				resonatingDispatch<ISA>(buffer, numChannels, numSamples);
+				publishResonatorState(numSamples);
 			}
 
 			return;
@@ -1627,6 +1848,7 @@ namespace Signalizer
 			}
 			case SpectrumChannels::Phase:
 			case SpectrumChannels::Separate:
+			case SpectrumChannels::Transfer:
 			{
 				cresonator.resonateReal<typename ISA::V>(buffer, 2, numSamples);
 				break;
@@ -70,6 +70,164 @@
 				Logarithmic
 			};
 
+			enum class OctaveSmoothing
+			{
+				None,
+				TwentyFourth,
+				Twelfth,
+				Sixth,
+				Third,
+				Octave
+			};
+
+			/// <summary>
+			/// Returns the full bandwidth in octaves of the fractional-octave smoothing, or zero if disabled.
+			/// </summary>
+			static double getOctaveBandwidth(OctaveSmoothing smoothing) noexcept
+			{
+				switch (smoothing)
+				{
+					case OctaveSmoothing::TwentyFourth: return 1.0 / 24;
+					case OctaveSmoothing::Twelfth: return 1.0 / 12;
+					case OctaveSmoothing::Sixth: return 1.0 / 6;
+					case OctaveSmoothing::Third: return 1.0 / 3;
+					case OctaveSmoothing::Octave: return 1.0;
+					default: return 0;
+				}
+			}
+
+			/// <summary>
+			/// Session-long average of the power in each linear transform bin (LTAS).
+			/// Memory is bounded by the transform size, and the running sums are compensated (Kahan)
+			/// so precision doesn't drift over hours of accumulation.
+			/// Any change in the bin layout restarts the average.
+			/// </summary>
+			class LongTermAverage : public cpl::CSerializer::Serializable
+			{
+			public:
+
+				/// <summary>
+				/// The most bins read from an archive: the transform of a 2^24 sample window, over five minutes at 48 kHz.
+				/// </summary>
+				static const std::size_t MaxBins = (1 << 24) + 1;
+
+				/// <summary>
+				/// Adds the power of each bin as a new frame, weighted by the amount of audio it represents.
+				/// Restarts the average if the layout changed, in which case memory is allocated.
+				/// </summary>
+				template<typename T>
+				void accumulate(const std::complex<T> * bins, std::size_t count, double sampleRate, std::uint64_t layout, double weight)
+				{
+					cpl::CMutex lock(mutex);
+
+					if (!matches(count, sampleRate, layout))
+						restart(count, sampleRate, layout);
+
+					for (std::size_t k = 0; k < count; ++k)
+					{
+						const double y = weight * std::norm(bins[k]) - compensation[k];
+						const double t = sums[k] + y;
+						compensation[k] = (t - sums[k]) - y;
+						sums[k] = t;
+					}
+
+					totalWeight += weight;
+					frames++;
+				}
+
+				/// <summary>
+				/// Overwrites the bins with the RMS magnitude of the average.
+				/// Returns false (and leaves the bins alone) if nothing has been accumulated for this layout.
+				/// </summary>
+				template<typename T>
+				bool snapshotInto(std::complex<T> * bins, std::size_t count, double sampleRate, std::uint64_t layout)
+				{
+					cpl::CMutex lock(mutex);
+
+					if (frames == 0 || totalWeight <= 0 || !matches(count, sampleRate, layout))
+						return false;
+
+					const double scale = 1.0 / totalWeight;
+
+					for (std::size_t k = 0; k < count; ++k)
+						bins[k] = static_cast<T>(std::sqrt(sums[k] * scale));
+
+					return true;
+				}
+
+				void reset()
+				{
+					cpl::CMutex lock(mutex);
+					std::fill(sums.begin(), sums.end(), 0.0);
+					std::fill(compensation.begin(), compensation.end(), 0.0);
+					totalWeight = 0;
+					frames = 0;
+				}
+
+				std::uint64_t getFrameCount() const noexcept
+				{
+					return frames;
+				}
+
+				void serialize(cpl::CSerializer::Archiver & ar, cpl::Version v) override
+				{
+					cpl::CMutex lock(mutex);
+
+					ar << static_cast<std::uint64_t>(sums.size()) << binSampleRate << binLayout << frames << totalWeight;
+					// the compensation is below the precision of the sums anyway
+					for (auto sum : sums)
+						ar << sum;
+				}
+
+				void deserialize(cpl::CSerializer::Builder & ar, cpl::Version v) override
+				{
+					cpl::CMutex lock(mutex);
+
+					std::uint64_t count, layout, storedFrames;
+					double sampleRate, storedWeight;
+					ar >> count >> sampleRate >> layout >> storedFrames >> storedWeight;
+
+					restart(static_cast<std::size_t>(std::min<std::uint64_t>(count, MaxBins)), sampleRate, layout);
+
+					for (auto & sum : sums)
+						ar >> sum;
+
+					// a truncated average doesn't describe any layout, so it's dropped
+					if (count > MaxBins)
+					{
+						restart(0, 0, 0);
+						return;
+					}
+
+					totalWeight = storedWeight;
+					frames = storedFrames;
+				}
+
+			private:
+
+				bool matches(std::size_t count, double sampleRate, std::uint64_t layout) const noexcept
+				{
+					return count == sums.size() && sampleRate == binSampleRate && layout == binLayout;
+				}
+
+				void restart(std::size_t count, double sampleRate, std::uint64_t layout)
+				{
+					sums.assign(count, 0.0);
+					compensation.assign(count, 0.0);
+					binSampleRate = sampleRate;
+					binLayout = layout;
+					totalWeight = 0;
+					frames = 0;
+				}
+
+				cpl::CMutex::Lockable mutex;
+				cpl::aligned_vector<double, 32> sums, compensation;
+				double binSampleRate = 0;
+				std::uint64_t binLayout = 0;
+				double totalWeight = 0;
+				std::atomic<std::uint64_t> frames { 0 };
+			};
+
 			static const std::size_t numSpectrumColours = 5;
 			static constexpr double kMinDbs = -24 * 16;
 			// the maximum level of dbs to display
@@ -92,6 +250,10 @@
 					, kdisplayMode(&parentValue.displayMode.param)
 					, kbinInterpolation(&parentValue.binInterpolation.param)
 					, kfrequencyTracker(&parentValue.frequencyTracker.param)
+					, koctaveSmoothing(&parentValue.octaveSmoothing.param)
+					, klongTermAverage(&parentValue.longTermAverage)
+					, ktransferAveraging(&parentValue.transferAveraging)
+					, kautoWindowSize(&parentValue.autoWindowSize)
 					, ktrackerColour(&parentValue.trackerColour)
 					, ktrackerSmoothing(&parentValue.trackerSmoothing)
 
@@ -229,6 +391,7 @@
 					kfrequencyTracker.bSetTitle("Frequency tracking");
 					kframeUpdateSmoothing.bSetTitle("Upd. smoothing");
 					kbinInterpolation.bSetTitle("Bin interpolation");
+					koctaveSmoothing.bSetTitle("Octave smoothing");
 					klowDbs.bSetTitle("Lower limit");
 					khighDbs.bSetTitle("Upper limit");
 					kwindowSize.bSetTitle("Window size");
@@ -236,6 +399,10 @@
 					kdiagnostics.setSingleText("Diagnostics");
 					kdiagnostics.setToggleable(true);
 					kfreeQ.setToggleable(true);
+					klongTermAverage.setSingleText("Long-term avg.");
+					klongTermAverage.setToggleable(true);
+					kautoWindowSize.setSingleText("Auto window");
+					kautoWindowSize.setToggleable(true);
 					kspectrumStretching.bSetTitle("Spectrum stretch");
 					kprimitiveSize.bSetTitle("Primitive size");
 					kfloodFillAlpha.bSetTitle("Flood fill %");
@@ -246,6 +413,7 @@
 					kblobSize.bSetTitle("Update speed");
 					ktrackerSmoothing.bSetTitle("Tracker smooth");
 					ktrackerColour.bSetTitle("Tracker colour");
+					ktransferAveraging.bSetTitle("Transfer avg.");
 
 					// ------ descriptions -----
 					kviewScaling.bSetDescription("Set the scale of the frequency-axis of the coordinate system.");
@@ -253,10 +421,16 @@
 					kchannelConfiguration.bSetDescription("Select how the audio channels are interpreted.");
 					kdisplayMode.bSetDescription("Select how the information is displayed; line graphs are updated each frame while the colour spectrum maintains the previous history.");
 					kbinInterpolation.bSetDescription("Choice of interpolation for transform algorithms that produce a discrete set of values instead of an continuous function.");
+					klongTermAverage.bSetDescription("Displays the power average of every transform since the last reset (LTAS), useful as a mix reference. "
+						"Only for FFT line graphs; use the refresh button to restart the average.");
+					koctaveSmoothing.bSetDescription("Averages the power of the FFT bins inside a fractional-octave band around each frequency, giving a smoothed spectrum with constant relative resolution.");
 					kdiagnostics.bSetDescription("Toggle diagnostic information in top-left corner.");
 					klowDbs.bSetDescription("The lower limit of the displayed dynamic range.");
 					khighDbs.bSetDescription("The upper limit of the displayed dynamic range");
 					kwindowSize.bSetDescription("The window size of the audio data, affects time/frequency resolution.");
+					kautoWindowSize.bSetDescription("Picks the smallest FFT that still resolves the finest visible pixel in the current view, "
+						"keeping the time resolution as good as the zoom level allows; the window size then acts as the upper limit. "
+						"The size is held while the long-term average runs, as a new size would restart it.");
 					kgridColour.bSetDescription("The colour of the dB/frequency grid.");
 					kbackgroundColour.bSetDescription("The colour of the background.");
 					kpctForDivision.bSetDescription("The minimum amount of free space that triggers a recursed frequency grid division; smaller values draw more frequency divisions.");
@@ -271,6 +445,8 @@
 					kreferenceTuning.bSetDescription("Reference tuning for A4; used when converting to/from musical notes and frequencies");
 					ktrackerSmoothing.bSetDescription("Eliminates small fluctuations and holds analysis values in the frequency tracker for a longer time");
 					ktrackerColour.bSetDescription("Colour of the frequency tracker");
+					ktransferAveraging.bSetDescription("Time constant of the running cross-spectrum averages used in the transfer channel configuration; "
+						"longer times give more stable transfer functions and coherence in noisy measurements.");
 
 					klines[LineGraphs::LineMain]->colourOne.bSetDescription("The colour of the first channel of the main graph.");
 					klines[LineGraphs::LineMain]->colourTwo.bSetDescription("The colour of the second channel of the main graph.");
@@ -312,6 +488,7 @@
 							section->addControl(&khighDbs, 0);
 							section->addControl(&kblobSize, 0);
 							section->addControl(&kwindowSize, 1);
+							section->addControl(&kautoWindowSize, 1);
 							section->addControl(&kpctForDivision, 0);
 							section->addControl(&kspectrumStretching, 1);
 							page->addSection(section);
@@ -331,6 +508,7 @@
 						{
 							section->addControl(&kalgorithm, 0);
 							section->addControl(&kbinInterpolation, 1);
+							section->addControl(&koctaveSmoothing, 0);
 							page->addSection(section);
 						}
 						if (auto section = new Signalizer::CContentPage::MatrixSection())
@@ -348,6 +526,8 @@
 						if (auto section = new Signalizer::CContentPage::MatrixSection())
 						{
 							section->addControl(&kfreeQ, 0);
+							section->addControl(&klongTermAverage, 1);
+							section->addControl(&ktransferAveraging, 0);
 							page->addSection(section);
 						}
 
@@ -448,6 +628,10 @@
 					archive << kreferenceTuning;
 					archive << ktrackerSmoothing;
 					archive << ktrackerColour;
+					archive << koctaveSmoothing;
+					archive << klongTermAverage;
+					archive << ktransferAveraging;
+					archive << kautoWindowSize;
 				}
 
 				void deserializeEditorSettings(cpl::CSerializer::Archiver & builder, cpl::Version version)
@@ -512,6 +696,14 @@
 					{
 						builder >> ktrackerSmoothing >> ktrackerColour;
 					}
+
+					if (version >= cpl::Version(0, 3, 2))
+					{
+						builder >> koctaveSmoothing;
+						builder >> klongTermAverage;
+						builder >> ktransferAveraging;
+						builder >> kautoWindowSize;
+					}
 				}
 
 				// entrypoints for completely storing values and settings in independant blobs (the preset widget)
@@ -553,7 +745,8 @@
 					kchannelConfiguration,
 					kdisplayMode,
 					kbinInterpolation,
-					kfrequencyTracker;
+					kfrequencyTracker,
+					koctaveSmoothing;
 
 				cpl::CDSPWindowWidget kdspWin;
 				cpl::CPowerSlopeWidget kslope;
@@ -568,7 +761,8 @@
 					kprimitiveSize,
 					kfloodFillAlpha,
 					kreferenceTuning,
-					ktrackerSmoothing;
+					ktrackerSmoothing,
+					ktransferAveraging;
 
 				cpl::CColourControl kgridColour, kbackgroundColour, ktrackerColour;
 
@@ -585,7 +779,7 @@
 				std::vector<std::unique_ptr<cpl::CValueKnobSlider>> kspecRatios;
 
 				cpl::CPresetWidget presetManager;
-				cpl::CButton kdiagnostics, kfreeQ;
+				cpl::CButton kdiagnostics, kfreeQ, klongTermAverage, kautoWindowSize;
 
 				SpectrumContent & parent;
 
@@ -604,6 +798,7 @@
 				, reverseUnitRange(1, 0)
 				, unitRange(0, 1)
 				, blobRange(0.5, 1000)
+				, transferAverageRange(10, 10000)
 				, spectrumStretchRange(1, 20)
 				, primitiveRange(0.01, 10)
 				, referenceRange(220, 880)
@@ -619,6 +814,7 @@
 				, displayMode("DispMode")
 				, binInterpolation("BinInt")
 				, frequencyTracker("FTracker")
+				, octaveSmoothing("OctSmooth")
 
 				, lowDbs("LowDBs", dynamicRange, literalDBFormatter)
 				, highDbs("HighDBs", dynamicRange, literalDBFormatter)
@@ -635,6 +831,9 @@
 				, diagnostics("Diagnostics", boolRange, boolFormatter)
 				, freeQ("FreeQ", boolRange, boolFormatter)
 				, trackerSmoothing("TrckSmth", trackerSmoothRange, msFormatter)
+				, longTermAverage("LTAS", boolRange, boolFormatter)
+				, transferAveraging("TrnsfAvg", transferAverageRange, msFormatter)
+				, autoWindowSize("AutoWin", boolRange, boolFormatter)
 
 				, colourBehaviour()
 
@@ -662,9 +861,10 @@
 
 				viewScaling.fmt.setValues({ "Linear", "Logarithmic" });
 				algorithm.fmt.setValues({ "FFT", "Resonator" });
-				channelConfiguration.fmt.setValues({ "Left", "Right", "Mid/Merge", "Side", "Phase", "Separate", "Mid+Side", "Complex" });
+				channelConfiguration.fmt.setValues({ "Left", "Right", "Mid/Merge", "Side", "Phase", "Separate", "Mid+Side", "Complex", "Transfer" });
 				displayMode.fmt.setValues({ "Line graph", "Colour spectrum" });
 				binInterpolation.fmt.setValues({ "None", "Linear", "Lanczos" });
+				octaveSmoothing.fmt.setValues({ "None", "1/24 oct", "1/12 oct", "1/6 oct", "1/3 oct", "1 oct" });
 
 				std::vector<std::string> frequencyTrackingOptions;
 
@@ -718,6 +918,12 @@
 					regBundle(lines[i].colourTwo, lines[i].colourTwo.getBundleName());
 				}
 
+				// registered last so earlier parameter indices stay stable
+				parameterSet.registerSingleParameter(octaveSmoothing.param.generateUpdateRegistrator());
+				parameterSet.registerSingleParameter(longTermAverage.generateUpdateRegistrator());
+				parameterSet.registerSingleParameter(transferAveraging.generateUpdateRegistrator());
+				parameterSet.registerSingleParameter(autoWindowSize.generateUpdateRegistrator());
+
 				parameterSet.seal();
 
 				postParameterInitialization();
@@ -777,6 +983,10 @@
 				archive << audioHistoryTransformatter;
 
 				archive << trackerSmoothing << trackerColour;
+				archive << octaveSmoothing.param;
+				archive << longTermAverage;
+				archive << transferAveraging;
+				archive << autoWindowSize;
 			}
 
 			virtual void deserialize(cpl::CSerializer::Builder & builder, cpl::Version v) override
@@ -826,6 +1036,24 @@
 				{
 					builder >> trackerSmoothing >> trackerColour;
 				}
+
+				if (v >= cpl::Version(0, 3, 2))
+				{
+					builder >> octaveSmoothing.param;
+					builder >> longTermAverage;
+					builder >> transferAveraging;
+					builder >> autoWindowSize;
+				}
+			}
+
+			void serializeMeasurements(cpl::CSerializer::Archiver & archive, cpl::Version v) override
+			{
+				archive << ltas;
+			}
+
+			void deserializeMeasurements(cpl::CSerializer::Builder & builder, cpl::Version v) override
+			{
+				builder >> ltas;
 			}
 
 			SystemView systemView;
@@ -848,7 +1076,8 @@
 				channelConfiguration,
 				displayMode,
 				binInterpolation,
-				frequencyTracker;
+				frequencyTracker,
+				octaveSmoothing;
 
 			Parameter
 				lowDbs,
@@ -874,7 +1103,19 @@
 				freeQ,
 				diagnostics,
 				specRatios[numSpectrumColours],
-				trackerSmoothing;
+				trackerSmoothing,
+				longTermAverage,
+				transferAveraging,
+				/// <summary>
+				/// Lets the view choose the window size from the zoom level, with windowSize as the upper limit.
+				/// </summary>
+				autoWindowSize;
+
+			/// <summary>
+			/// Accumulated by the view while longTermAverage is toggled. A measurement of the session,
+			/// so it's only persisted with the host state and never in presets.
+			/// </summary>
+			LongTermAverage ltas;
 
 			cpl::ParameterColourValue<ParameterSet::ParameterView>
 				gridColour,
@@ -908,7 +1149,8 @@
 				trackerSmoothRange;
 
 			cpl::ExponentialRange<SFloat>
-				blobRange;
+				blobRange,
+				transferAverageRange;
 
 			cpl::ParameterColourValue<ParameterSet::ParameterView>::SharedBehaviour colourBehaviour;
 
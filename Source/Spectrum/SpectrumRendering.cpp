@@ -205,6 +205,11 @@ namespace Signalizer
 
 			g.drawSingleLineText(text, 10, 20);
 
+			if (state.longTermAverage)
+			{
+				sprintf(text, "LTAS: %llu frames", static_cast<unsigned long long>(content->ltas.getFrameCount()));
+				g.drawSingleLineText(text, 10, 40);
+			}
 		}
 	}
 
@@ -568,6 +573,18 @@ namespace Signalizer
 			-adjustedScallopLoss
 		);
 
+		if (state.configuration == SpectrumChannels::Transfer && transferPhase.size())
+		{
+			auto const index = cpl::Math::confineTo((std::size_t)mouseX, 0, transferPhase.size() - 1);
+			auto const length = std::strlen(buf);
+			std::snprintf(buf + length, sizeof(buf) - length, utf8_literal(u8"\n+H:  %+7.2f\u00B0, \u03B3\u00B2 %5.3f"),
+				transferPhase[index] * 180 / cpl::simd::consts<double>::pi,
+				lineGraphs[SpectrumContent::LineGraphs::LineMain].results[index].rightMagnitude
+			);
+			estimatedSize[1] += 15;
+			textOffset[1] = -estimatedSize[1];
+		}
+
 		// render text rectangle
 		auto xpoint = mouseX + textOffset[0] ;
 		if (xpoint + estimatedSize[0] > getWidth())
@@ -601,13 +618,14 @@ namespace Signalizer
 		//oglImage.resize(getWidth(), getHeight(), false);
 		flags.openGLInitiation = true;
 		textures.clear();
-
+		lineStream.create();
 	}
 
 	void Spectrum::closeOpenGL()
 	{
 		textures.clear();
 		oglImage.offload();
+		lineStream.release();
 	}
 
 
@@ -712,8 +730,16 @@ namespace Signalizer
                 // line graph data for ffts are rendered now.
                 if (state.displayMode == SpectrumContent::DisplayMode::LineGraph)
                 {
-                    audioLock.acquire(audioResource);
-                    lineTransformReady = prepareTransform(audioStream.getAudioBufferViews());
+                    // resonator frames are published by the audio thread, so no need to lock
+                    if (state.algo.load(std::memory_order_acquire) == SpectrumContent::TransformAlgorithm::RSNT)
+                    {
+                        lineTransformReady = true;
+                    }
+                    else
+                    {
+                        audioLock.acquire(audioResource);
+                        lineTransformReady = prepareTransform(audioStream.getAudioBufferViews());
+                    }
                 }
 
             }
@@ -739,9 +765,12 @@ namespace Signalizer
                 // such that only we have access to it.
                 if (lineTransformReady)
                 {
-                    audioLock.acquire(audioResource);
-                    doTransform();
-                    mapToLinearSpace();
+                    if (state.algo.load(std::memory_order_acquire) == SpectrumContent::TransformAlgorithm::FFT)
+                    {
+                        audioLock.acquire(audioResource);
+                        doTransform();
+                        mapToLinearSpace();
+                    }
                     postProcessStdTransform();
                 }
                 renderLineGraph<ISA>(openGLStack); break;
@@ -898,6 +927,7 @@ namespace Signalizer
 				case SpectrumChannels::MidSide:
 				case SpectrumChannels::Phase:
 				case SpectrumChannels::Separate:
+				case SpectrumChannels::Transfer:
 				{
 					OpenGLRendering::PrimitiveDrawer<512> lineDrawer(ogs, GL_LINES);
 					lineDrawer.addColour(state.colourTwo[k].withAlpha(state.alphaFloodFill));
@@ -932,22 +962,53 @@ namespace Signalizer
 
 		// render the line graphs
 		ogs.setBlender(GL_ONE, GL_ONE_MINUS_SRC_COLOR);
-		ogs.setLineSize(std::max(0.001f, static_cast<float>(oglc->getRenderingScale() * state.primitiveSize)));
+		const float lineWidth = std::max(0.001f, static_cast<float>(oglc->getRenderingScale() * state.primitiveSize));
+		ogs.setLineSize(lineWidth);
+
+		// the line shader widens and antialiases the graphs, if it's available
+		auto const view = LineTransform::identity()
+			.translate(-1, -1, 0)
+			.scale(static_cast<float>(1.0 / (points * 0.5)), 2, 1);
+
+		auto drawGraph = [&](juce::Colour colour, GLfloat depth, auto && magnitudeAt)
+		{
+			if (lineStream.isCreated())
+			{
+				const LineGeometry::Colour lineColour{ colour.getRed(), colour.getGreen(), colour.getBlue(), colour.getAlpha() };
+
+				lineGeometry.clear();
+				lineGeometry.addStrip(
+					static_cast<std::size_t>(points + 1),
+					[&](std::size_t i) { return LineGeometry::Point{ static_cast<float>(i), static_cast<float>(magnitudeAt(i)), depth }; },
+					[&](std::size_t) { return lineColour; }
+				);
+
+				lineStream.draw(lineGeometry, view, lineWidth, state.antialias);
+			}
+			else
+			{
+				OpenGLRendering::PrimitiveDrawer<256> lineDrawer(ogs, GL_LINE_STRIP);
+				lineDrawer.addColour(colour);
+				for (int i = 0; i < (points + 1); ++i)
+				{
+					lineDrawer.addVertex(i, magnitudeAt(i), depth);
+				}
+			}
+		};
+
 		// draw back to front
 		for (int k = SpectrumContent::LineGraphs::LineEnd - 1; k >= 0; --k)
 		{
+			const auto & results = lineGraphs[k].results;
+
 			switch (state.configuration)
 			{
 			case SpectrumChannels::MidSide:
 			case SpectrumChannels::Phase:
 			case SpectrumChannels::Separate:
+			case SpectrumChannels::Transfer:
 			{
-				OpenGLRendering::PrimitiveDrawer<256> lineDrawer(ogs, GL_LINE_STRIP);
-				lineDrawer.addColour(state.colourTwo[k]);
-				for (int i = 0; i < (points + 1); ++i)
-				{
-					lineDrawer.addVertex(i, lineGraphs[k].results[i].rightMagnitude, -0.5);
-				}
+				drawGraph(state.colourTwo[k], -0.5f, [&](std::size_t i) { return results[i].rightMagnitude; });
 			}
 			// (fall-through intentional)
 			case SpectrumChannels::Left:
@@ -956,12 +1017,7 @@ namespace Signalizer
 			case SpectrumChannels::Side:
 			case SpectrumChannels::Complex:
 			{
-				OpenGLRendering::PrimitiveDrawer<256> lineDrawer(ogs, GL_LINE_STRIP);
-				lineDrawer.addColour(state.colourOne[k]);
-				for (int i = 0; i < (points + 1); ++i)
-				{
-					lineDrawer.addVertex(i, lineGraphs[k].results[i].leftMagnitude, 0);
-				}
+				drawGraph(state.colourOne[k], 0.0f, [&](std::size_t i) { return results[i].leftMagnitude; });
 			}
 			default:
 				break;
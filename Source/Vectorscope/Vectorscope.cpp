@@ -236,6 +236,11 @@ namespace Signalizer
 		state.rotation = content->waveZRotation.getNormalizedValue();
 		state.primitiveSize = content->primitiveSize.getTransformedValue();
 		state.userGain = content->inputGain.getTransformedValue();
+		state.accumulate = content->accumulate.getTransformedValue() > 0.5;
+		state.accumulationDecay = static_cast<float>(content->accumulationDecay.getTransformedValue());
+		// the first choice is broadband, the rest count from three bands
+		const auto bandChoice = static_cast<std::size_t>(content->meterBands.param.getTransformedValue());
+		state.meterBands = bandChoice ? bandChoice + 2 : 1;
 
 		state.colourDraw = content->drawingColour.getAsJuceColour();
 		state.colourWire = content->skeletonColour.getAsJuceColour();
@@ -275,79 +280,121 @@ namespace Signalizer
 			if (numChannels != 2)
 				return;
 
+			appendCoordinates<ISA>(buffer, numSamples);
+
+			if (state.meterBands > 1)
+				filterBands<ISA>(buffer, numSamples);
+
+			using fs = FilterStates;
+
 			T filterEnv[2] = { filters.envelope[0], filters.envelope[1] };
 			T stereoPoles[2] = { state.stereoCoeff, std::pow(state.stereoCoeff, state.secondStereoFilterSpeed) };
 
 			const T cosineRotation = (T)std::cos(M_PI * 135 / 180);
 			const T sineRotation = (T)std::sin(M_PI * 135 / 180);
-			const V vMatrixReal = set1<V>(cosineRotation);
-			const V vMatrixImag = set1<V>(sineRotation);
 
-			const V vDummyAngle = set1<V>((T)(M_PI * 0.25));
-			const V vZero = zero<V>();
+			// inputs of the filters
+			enum Input { LeftSquared, RightSquared, Phase };
 
-			auto const loopIncrement = elements_of<V>::value;
+			// every one-pole filter: its input, pole and state
+			struct Statistic
+			{
+				Input input;
+				T pole;
+				T & y;
+			};
 
-			// ensure a perfect multiple and no buffer overrun
-			numSamples -= numSamples & (loopIncrement - 1);
+			Statistic statistics[] =
+			{
+				{ LeftSquared, state.envelopeCoeff, filterEnv[0] },
+				{ RightSquared, state.envelopeCoeff, filterEnv[1] },
+				{ LeftSquared, stereoPoles[fs::Slow], filters.balance[fs::Slow][fs::Left] },
+				{ RightSquared, stereoPoles[fs::Slow], filters.balance[fs::Slow][fs::Right] },
+				{ LeftSquared, stereoPoles[fs::Fast], filters.balance[fs::Fast][fs::Left] },
+				{ RightSquared, stereoPoles[fs::Fast], filters.balance[fs::Fast][fs::Right] },
+				{ Phase, stereoPoles[0], filters.phase[0] },
+				{ Phase, stereoPoles[1], filters.phase[1] }
+			};
+
+			const std::size_t numStatistics = std::extent<decltype(statistics)>::value;
+
+			// the phase angle of the view rotated 135 degrees is discontinuous around PI, so the cosine of the doubled
+			// angle is used instead. cos(2 * atan(y / x)) = (x^2 - y^2) / (x^2 + y^2), defined as zero for silence.
+
+			// only the states at the end of the block are used, so the vectors of samples are filtered in closed form:
+			// y[N] = p^N * y[0] + (1 - p) * sum(p^(N - 1 - n) * x[n]).
+			// each lane sums its own samples, decayed by p^lanes per vector, and the lanes are weighted together afterwards.
+			auto const lanes = elements_of<V>::value;
+			const std::size_t vectorSamples = numSamples - (numSamples & (lanes - 1));
+
+			if (vectorSamples)
+			{
+				V accumulators[numStatistics], vectorDecays[numStatistics];
 
-			suitable_container<V> outputPhases;
+				for (std::size_t s = 0; s < numStatistics; ++s)
+				{
+					accumulators[s] = zero<V>();
+					vectorDecays[s] = set1<V>(static_cast<T>(std::pow(statistics[s].pole, lanes)));
+				}
 
-			for (std::size_t n = 0; n < numSamples; n += loopIncrement)
-			{
-				// some of the heavy math done in vector mode..
-				const V vLeft = loadu<V>(buffer[0] + n);
-				const V vRight = loadu<V>(buffer[1] + n);
-
-				// rotate 235 degrees...
-				const V vX = vLeft * vMatrixReal - vRight * vMatrixImag;
-				const V vY = vRight * vMatrixImag + vLeft * vMatrixReal;
-
-				// check if both axes are zero
-				const V vZeroAxes = vand((V)(vX == vZero), (V)(vY == vZero));
-
-				// compute the phase angle and replace the zero vector elements with the dummy angle (to avoid nans, +/-infs are defined)
-				const V vRadians = atan(vY / vX);
-				const V vPhaseAngle = vselect(vDummyAngle, vRadians, vZeroAxes);
-
-				outputPhases = vPhaseAngle;
-				// the phase angle is discontinuous around PI, so we take the cosine
-				// to avoid the discontinuity and give a small smoothing
-				// for some arcane fucking reason, the phase response of this function IN THIS CONTEXT is wrong
-				// testing reveals no problems, it just doesn't work right here. Uncomment if you find a fix.
-#pragma message cwarn("Errornous cosine output here.")
-				//outputPhases = cos(outputPhases * set1<V>(2));
-
-				// scalar code segment for recursive IIR filters..
-				for (std::size_t i = 0; i < loopIncrement; ++i)
+				const V
+					vCosine = set1<V>(cosineRotation),
+					vSine = set1<V>(sineRotation),
+					vZero = zero<V>();
+
+				for (std::size_t n = 0; n < vectorSamples; n += lanes)
 				{
-					auto const z = n + i;
-					// collect squared inputs (really just a cheap abs)
-					const auto lSquared = buffer[0][z] * buffer[0][z];
-					const auto rSquared = buffer[1][z] * buffer[1][z];
+					const V vLeft = loadu<V>(buffer[0] + n);
+					const V vRight = loadu<V>(buffer[1] + n);
 
-					// average envelope
-					filterEnv[0] = lSquared + state.envelopeCoeff * (filterEnv[0] - lSquared);
-					filterEnv[1] = rSquared + state.envelopeCoeff * (filterEnv[1] - rSquared);
+					const V vX = vLeft * vCosine - vRight * vSine;
+					const V vY = vRight * vSine + vLeft * vCosine;
+					const V vXX = vX * vX, vYY = vY * vY, vLength = vXX + vYY;
 
-					// balance average source
+					V inputs[3];
+					inputs[LeftSquared] = vLeft * vLeft;
+					inputs[RightSquared] = vRight * vRight;
+					// replace the nans of silent samples with zero
+					inputs[Phase] = vand(vnot((V)(vLength == vZero)), (vXX - vYY) / vLength);
 
-					using fs = FilterStates;
+					for (std::size_t s = 0; s < numStatistics; ++s)
+						accumulators[s] = accumulators[s] * vectorDecays[s] + inputs[statistics[s].input];
+				}
 
-					filters.balance[fs::Slow][fs::Left]  = lSquared + stereoPoles[fs::Slow] * (filters.balance[fs::Slow][fs::Left]  - lSquared);
-					filters.balance[fs::Slow][fs::Right] = rSquared + stereoPoles[fs::Slow] * (filters.balance[fs::Slow][fs::Right] - rSquared);
-					filters.balance[fs::Fast][fs::Left]  = lSquared + stereoPoles[fs::Fast] * (filters.balance[fs::Fast][fs::Left]  - lSquared);
-					filters.balance[fs::Fast][fs::Right] = rSquared + stereoPoles[fs::Fast] * (filters.balance[fs::Fast][fs::Right] - rSquared);
+				for (std::size_t s = 0; s < numStatistics; ++s)
+				{
+					const double pole = statistics[s].pole;
+					suitable_container<V> sums = accumulators[s];
 
-					// phase averaging
-					// see larger comment above.
-					outputPhases[i] = cos(outputPhases[i] * consts<T>::two);
-					filters.phase[0] = outputPhases[i] + stereoPoles[0] * (filters.phase[0] - outputPhases[i]);
-					filters.phase[1] = outputPhases[i] + stereoPoles[1] * (filters.phase[1] - outputPhases[i]);
+					double sum = 0;
+
+					for (std::size_t i = 0; i < lanes; ++i)
+						sum += sums[i] * std::pow(pole, lanes - 1 - i);
+
+					statistics[s].y = static_cast<T>(std::pow(pole, vectorSamples) * statistics[s].y + (1 - pole) * sum);
 				}
+			}
 
+			// remaining samples, sample by sample
+			for (std::size_t n = vectorSamples; n < numSamples; ++n)
+			{
+				const T left = buffer[0][n], right = buffer[1][n];
+				const T x = left * cosineRotation - right * sineRotation;
+				const T y = right * sineRotation + left * cosineRotation;
+				const T xx = x * x, yy = y * y, length = xx + yy;
+
+				T inputs[3];
+				inputs[LeftSquared] = left * left;
+				inputs[RightSquared] = right * right;
+				inputs[Phase] = length != 0 ? (xx - yy) / length : 0;
 
+				for (auto & statistic : statistics)
+				{
+					const auto input = inputs[statistic.input];
+					statistic.y = input + statistic.pole * (statistic.y - input);
+				}
 			}
+
 			// store calculated envelope
 			if (state.envelopeMode == EnvelopeModes::RMS && state.normalizeGain)
 			{
@@ -367,6 +414,284 @@ namespace Signalizer
 
 		}
 
+	template<typename ISA>
+		void VectorScope::appendCoordinates(AudioStream::DataType ** buffer, std::size_t numSamples)
+		{
+			typedef typename ISA::V V;
+			using namespace cpl::simd;
+			using cpl::simd::abs;
+
+			auto & c = coordinates;
+			cpl::CMutex lock(c.lock);
+
+			const std::size_t frames = audioStream.getAudioHistorySize();
+
+			if (frames != c.frames)
+			{
+				c.frames = frames;
+				c.cursor = c.filled = 0;
+				c.written = 0;
+				c.version++;
+
+				for (auto & ring : c.rings)
+					ring.assign(2 * frames, 0);
+
+				for (auto & envelope : c.envelopes)
+				{
+					envelope.resize(frames);
+					envelope.clear();
+				}
+			}
+
+			if (!frames)
+				return;
+
+			c.written += numSamples;
+			c.version++;
+
+			// only the newest frames fit
+			const auto skip = numSamples > frames ? numSamples - frames : 0;
+			const AudioStream::DataType * left = buffer[0] + skip, * right = buffer[1] + skip;
+			numSamples -= skip;
+
+			// rotates the view to center on the y-axis, see drawPolarPlot()
+			const V
+				vCosine = consts<V>::sqrt_half_two_minus,
+				vSine = consts<V>::sqrt_half_two,
+				vZero = zero<V>();
+
+			auto * const rect = c.rings[CoordinateStream::Rect].data();
+			auto * const polar = c.rings[CoordinateStream::Polar].data();
+
+			auto append = [&](const AudioStream::DataType * l, const AudioStream::DataType * r, V vLeft, V vRight, std::size_t lanes)
+			{
+				// the length of the hypotenuse of the triangle, we convert the unit square to.
+				auto const vLength = max(abs(vLeft), abs(vRight));
+
+				V vY = vLeft * vCosine - vRight * vSine;
+				V vX = vLeft * vSine + vRight * vCosine;
+
+				// replace the nan angles of silent samples with zero
+				auto const vMask = vnot(vand((V)(vLeft == vZero), (V)(vRight == vZero)));
+				auto const vAngle = vand(vMask, atan(vX / vY));
+
+				sincos(vAngle, &vX, &vY);
+
+				suitable_container<V> x = vX * vLength, y = vY * vLength;
+
+				for (std::size_t n = 0; n < lanes; ++n)
+				{
+					rect[2 * c.cursor] = r[n];
+					rect[2 * c.cursor + 1] = l[n];
+					polar[2 * c.cursor] = x[n];
+					polar[2 * c.cursor + 1] = y[n];
+					c.envelopes[0].add(l[n]);
+					c.envelopes[1].add(r[n]);
+
+					if (++c.cursor == c.frames)
+						c.cursor = 0;
+				}
+			};
+
+			auto const lanes = elements_of<V>::value;
+			std::size_t n = 0;
+
+			for (; n + lanes <= numSamples; n += lanes)
+				append(left + n, right + n, loadu<V>(left + n), loadu<V>(right + n), lanes);
+
+			if (n < numSamples)
+			{
+				// zero padded remainder
+				suitable_container<V> leftRest = zero<V>(), rightRest = zero<V>();
+
+				for (std::size_t i = 0; n + i < numSamples; ++i)
+				{
+					leftRest[i] = left[n + i];
+					rightRest[i] = right[n + i];
+				}
+
+				append(left + n, right + n, leftRest.toType(), rightRest.toType(), numSamples - n);
+			}
+
+			c.filled = std::min(frames, c.filled + numSamples);
+
+			// the oldest few samples of the history that don't fill a bucket of the envelopes are read from the ring
+			const auto oldest = (c.cursor + frames - c.filled) % frames;
+
+			for (std::size_t channel = 0; channel < 2; ++channel)
+			{
+				std::size_t uncovered = 0;
+				auto peak = c.envelopes[channel].getExtremes(c.filled, uncovered).peak();
+
+				// the rect form is (right, left) pairs
+				for (std::size_t n = 0, index = oldest; n < uncovered; ++n)
+				{
+					peak = std::max(peak, std::abs(rect[2 * index + 1 - channel]));
+
+					if (++index == frames)
+						index = 0;
+				}
+
+				c.peaks[channel] = peak;
+			}
+		}
+
+	template<typename ISA>
+		void VectorScope::filterBands(AudioStream::DataType ** buffer, std::size_t numSamples)
+		{
+			typedef typename ISA::V V;
+			using namespace cpl::simd;
+
+			auto & b = bandMeters;
+			const double sampleRate = audioStream.getInfo().sampleRate;
+
+			if (b.bands != state.meterBands || b.sampleRate != sampleRate)
+				designBands(state.meterBands, sampleRate);
+
+			const std::size_t Stages = BandMeters::Stages;
+			auto const lanes = elements_of<V>::value;
+
+			auto store = [](const V & vector, AFloat * destination)
+			{
+				suitable_container<V> values = vector;
+
+				for (std::size_t i = 0; i < elements_of<V>::value; ++i)
+					destination[i] = values[i];
+			};
+
+			const V vPole = set1<V>(state.stereoCoeff);
+
+			// each group of bands is filtered through the whole block before the next,
+			// so its coefficients and states stay in registers
+			for (std::size_t g = 0; g < b.bands; g += lanes)
+			{
+				V b0[Stages], b1[Stages], b2[Stages], a1[Stages], a2[Stages], states[2][Stages][2];
+
+				for (std::size_t k = 0; k < Stages; ++k)
+				{
+					b0[k] = loadu<V>(b.sections[k].b0.data() + g);
+					b1[k] = loadu<V>(b.sections[k].b1.data() + g);
+					b2[k] = loadu<V>(b.sections[k].b2.data() + g);
+					a1[k] = loadu<V>(b.sections[k].a1.data() + g);
+					a2[k] = loadu<V>(b.sections[k].a2.data() + g);
+
+					for (std::size_t c = 0; c < 2; ++c)
+					{
+						states[c][k][0] = loadu<V>(b.states[c][k][0].data() + g);
+						states[c][k][1] = loadu<V>(b.states[c][k][1].data() + g);
+					}
+				}
+
+				V
+					vLeftPower = loadu<V>(b.leftPower.data() + g),
+					vRightPower = loadu<V>(b.rightPower.data() + g),
+					vCrossPower = loadu<V>(b.crossPower.data() + g);
+
+				for (std::size_t n = 0; n < numSamples; ++n)
+				{
+					V outputs[2];
+
+					for (std::size_t c = 0; c < 2; ++c)
+					{
+						V x = set1<V>(buffer[c][n]);
+
+						for (std::size_t k = 0; k < Stages; ++k)
+						{
+							const V y = b0[k] * x + states[c][k][0];
+							states[c][k][0] = b1[k] * x - a1[k] * y + states[c][k][1];
+							states[c][k][1] = b2[k] * x - a2[k] * y;
+							x = y;
+						}
+
+						outputs[c] = x;
+					}
+
+					const V
+						vLeft = outputs[0] * outputs[0],
+						vRight = outputs[1] * outputs[1],
+						vCross = outputs[0] * outputs[1];
+
+					vLeftPower = vLeft + vPole * (vLeftPower - vLeft);
+					vRightPower = vRight + vPole * (vRightPower - vRight);
+					vCrossPower = vCross + vPole * (vCrossPower - vCross);
+				}
+
+				for (std::size_t k = 0; k < Stages; ++k)
+				{
+					for (std::size_t c = 0; c < 2; ++c)
+					{
+						store(states[c][k][0], b.states[c][k][0].data() + g);
+						store(states[c][k][1], b.states[c][k][1].data() + g);
+					}
+				}
+
+				store(vLeftPower, b.leftPower.data() + g);
+				store(vRightPower, b.rightPower.data() + g);
+				store(vCrossPower, b.crossPower.data() + g);
+			}
+		}
+
+	void VectorScope::designBands(std::size_t bands, double sampleRate)
+	{
+		auto & b = bandMeters;
+		const auto count = std::min(bands, BandMeters::MaxBands);
+
+		// every section passes the input through, until designed otherwise
+		for (auto & section : b.sections)
+		{
+			section.b0.fill(1);
+			section.b1.fill(0);
+			section.b2.fill(0);
+			section.a1.fill(0);
+			section.a2.fill(0);
+		}
+
+		for (auto & channel : b.states)
+			for (auto & section : channel)
+				for (auto & lanes : section)
+					lanes.fill(0);
+
+		b.leftPower.fill(0);
+		b.rightPower.fill(0);
+		b.crossPower.fill(0);
+
+		// butterworth sections from the audio eq cookbook, two in a row make a Linkwitz-Riley edge
+		auto designSection = [&](std::size_t lane, std::size_t stage, bool highPass, double frequency)
+		{
+			const double omega = 2 * M_PI * frequency / sampleRate;
+			const double cosine = std::cos(omega), alpha = std::sin(omega) / std::sqrt(2.0);
+			const double a0 = 1 + alpha;
+			const double gain = highPass ? (1 + cosine) / 2 : (1 - cosine) / 2;
+
+			auto & section = b.sections[stage];
+			section.b0[lane] = static_cast<AFloat>(gain / a0);
+			section.b1[lane] = static_cast<AFloat>((highPass ? -2 : 2) * gain / a0);
+			section.b2[lane] = static_cast<AFloat>(gain / a0);
+			section.a1[lane] = static_cast<AFloat>(-2 * cosine / a0);
+			section.a2[lane] = static_cast<AFloat>((1 - alpha) / a0);
+		};
+
+		if (count > 1 && sampleRate > 0)
+		{
+			// crossovers are spaced logarithmically, densest in the low end where mono compatibility matters
+			const double lowest = 150, highest = std::min(6000.0, sampleRate * 0.4);
+
+			for (std::size_t i = 0; i + 1 < count; ++i)
+			{
+				const double crossover = lowest * std::pow(highest / lowest, count > 2 ? double(i) / (count - 2) : 0.0);
+
+				// the band below gets its high edge here, and the band above its low edge
+				designSection(i, 2, false, crossover);
+				designSection(i, 3, false, crossover);
+				designSection(i + 1, 0, true, crossover);
+				designSection(i + 1, 1, true, crossover);
+			}
+		}
+
+		b.sampleRate = sampleRate;
+		b.bands = count;
+	}
+
 	bool VectorScope::onAsyncAudio(const AudioStream & source, AudioStream::DataType ** buffer, std::size_t numChannels, std::size_t numSamples)
 	{
 		if (state.isSuspended && globalBehaviour.stopProcessingOnSuspend.load(std::memory_order_relaxed))
@@ -35,7 +35,9 @@
 	#include <cpl/gui/controls/Controls.h>
 	#include <cpl/gui/widgets/Widgets.h>
 	#include <memory>
+	#include <array>
 	#include <cpl/simd.h>
+	#include <cpl/CMutex.h>
 	#include "VectorscopeParameters.h"
 
 	namespace cpl
@@ -161,26 +163,56 @@
 
 			// vector-accelerated drawing, rendering and processing
 			template<typename ISA>
-				void drawPolarPlot(cpl::OpenGLRendering::COpenGLStack &, const AudioStream::AudioBufferAccess &);
+				void drawPolarPlot(cpl::OpenGLRendering::COpenGLStack &);
 
 			template<typename ISA>
-				void drawRectPlot(cpl::OpenGLRendering::COpenGLStack &, const AudioStream::AudioBufferAccess &);
+				void drawRectPlot(cpl::OpenGLRendering::COpenGLStack &);
 
+			/// <summary>
+			/// Splats the coordinates that arrived since the last frame into the phosphor density image.
+			/// </summary>
+			void accumulatePhosphor();
+
+			/// <summary>
+			/// Decays the phosphor density by the time since the last frame, colour maps it and draws it.
+			/// </summary>
 			template<typename ISA>
-				void drawWireFrame(cpl::OpenGLRendering::COpenGLStack &);
+				void drawPhosphor(cpl::OpenGLRendering::COpenGLStack &);
 
 			template<typename ISA>
-				void drawGraphText(cpl::OpenGLRendering::COpenGLStack &, const AudioStream::AudioBufferAccess &);
+				void drawWireFrame(cpl::OpenGLRendering::COpenGLStack &);
 
 			template<typename ISA>
-				void drawStereoMeters(cpl::OpenGLRendering::COpenGLStack &, const AudioStream::AudioBufferAccess &);
+				void drawGraphText(cpl::OpenGLRendering::COpenGLStack &);
 
 			template<typename ISA>
-				void runPeakFilter(const AudioStream::AudioBufferAccess &);
+				void drawStereoMeters(cpl::OpenGLRendering::COpenGLStack &);
+
+			/// <summary>
+			/// Decays the auto-gain envelope towards the peaks of the snapshot.
+			/// </summary>
+			void runPeakFilter();
 
 			template<typename ISA>
 				void audioProcessing(AudioStream::DataType ** buffer, std::size_t numChannels, std::size_t numSamples);
 
+			/// <summary>
+			/// Transforms the incoming stereo samples into the display coordinates of both plots, and appends them to the coordinate rings.
+			/// </summary>
+			template<typename ISA>
+				void appendCoordinates(AudioStream::DataType ** buffer, std::size_t numSamples);
+
+			/// <summary>
+			/// Splits the incoming stereo samples into the crossover bands, and updates the statistics of each band.
+			/// </summary>
+			template<typename ISA>
+				void filterBands(AudioStream::DataType ** buffer, std::size_t numSamples);
+
+			/// <summary>
+			/// Redesigns the crossover bands and clears their states.
+			/// </summary>
+			void designBands(std::size_t bands, double sampleRate);
+
 			void initPanelAndControls();
 
 			// guis and whatnot
@@ -207,6 +239,41 @@
 
 			} filters;
 
+			/// <summary>
+			/// Per band stereo statistics for the multi-band meters. Every band is a fourth order Linkwitz-Riley band-pass
+			/// (two butterworth sections per edge) of the input, and the bands are filtered in parallel, one per vector lane.
+			/// Lanes of missing edges and unused bands pass the input through. Written by the audio thread.
+			/// </summary>
+			struct BandMeters
+			{
+				static const std::size_t MaxBands = 10;
+				/// <summary>
+				/// Room for the bands rounded up to any vector width
+				/// </summary>
+				static const std::size_t Lanes = 16;
+				static const std::size_t Stages = 4;
+
+				typedef std::array<AFloat, Lanes> LaneArray;
+
+				struct Section
+				{
+					LaneArray b0, b1, b2, a1, a2;
+				};
+
+				std::array<Section, Stages> sections;
+				/// <summary>
+				/// Transposed direct form II states of each section, for each channel
+				/// </summary>
+				std::array<std::array<std::array<LaneArray, 2>, Stages>, 2> states;
+				/// <summary>
+				/// Smoothed left * left, right * right and left * right
+				/// </summary>
+				LaneArray leftPower, rightPower, crossPower;
+
+				std::size_t bands = 0;
+				double sampleRate = 0;
+			} bandMeters;
+
 			struct Flags
 			{
 				cpl::ABoolFlag
@@ -225,8 +292,10 @@
 			// contains non-atomic structures
 			struct StateOptions
 			{
-				bool isPolar, normalizeGain, isFrozen, fillPath, fadeHistory, antialias, diagnostics, isSuspended;
+				bool isPolar, normalizeGain, isFrozen, fillPath, fadeHistory, antialias, diagnostics, isSuspended, accumulate;
 				float primitiveSize, rotation;
+				float accumulationDecay;
+				std::size_t meterBands;
 				float stereoCoeff;
 				float envelopeCoeff;
 				/// <summary>
@@ -238,6 +307,107 @@
 				EnvelopeModes envelopeMode;
 			} state;
 
+			/// <summary>
+			/// Display coordinates of the audio history, computed once when the samples arrive instead of every frame.
+			/// Each form is a ring of interleaved x, y pairs in the unit space of its plot, before gain and rotation.
+			/// Written by the audio thread and copied out by the renderer, under the lock.
+			/// </summary>
+			struct CoordinateStream
+			{
+				enum Form
+				{
+					Rect,
+					Polar,
+					Forms
+				};
+
+				cpl::CMutex::Lockable lock;
+				std::array<cpl::aligned_vector<GLfloat, 32>, Forms> rings;
+				std::size_t frames = 0, cursor = 0, filled = 0;
+				/// <summary>
+				/// The amount of frames appended since the rings were last resized
+				/// </summary>
+				std::uint64_t written = 0;
+				/// <summary>
+				/// Changes every time the rings are modified
+				/// </summary>
+				std::uint64_t version = 0;
+				/// <summary>
+				/// Envelopes of the left and right channel, so their peaks are found without scanning the history
+				/// </summary>
+				std::array<EnvelopePyramid, 2> envelopes;
+				/// <summary>
+				/// The largest magnitude of the left and right channel in the history
+				/// </summary>
+				std::array<AFloat, 2> peaks{};
+			} coordinates;
+
+			/// <summary>
+			/// A render owned copy of the newest count coordinates of the history, oldest first.
+			/// Everything drawn from the history uses this, so the lock is only held while copying.
+			/// </summary>
+			struct Snapshot
+			{
+				std::array<cpl::aligned_vector<GLfloat, 32>, CoordinateStream::Forms> pairs;
+				/// <summary>
+				/// The coordinates held in pairs, and in the history
+				/// </summary>
+				std::size_t count = 0, filled = 0;
+				std::uint64_t written = 0, version = 0;
+				std::array<AFloat, 2> peaks{};
+				/// <summary>
+				/// Set if only the coordinates new to the phosphor were copied, of the displayed form
+				/// </summary>
+				bool incremental = false;
+			} snapshot;
+
+			/// <summary>
+			/// Copies the coordinate history into the snapshot, if it changed since the last time.
+			/// When accumulating, only the coordinates the phosphor hasn't consumed are copied, so the cost
+			/// follows the input rate instead of the history size.
+			/// </summary>
+			void updateSnapshot();
+
+			/// <summary>
+			/// The snapshot of a plot expanded with the depth and fade of each vertex.
+			/// Only touched by the rendering thread.
+			/// </summary>
+			struct VertexBuffer
+			{
+				cpl::aligned_vector<GLfloat, 32> vertices;
+				std::vector<GLubyte> colours;
+			} vertexBuffer;
+
+			/// <summary>
+			/// Widened line strips of the snapshot, streamed to the line shader. Only touched by the rendering thread.
+			/// </summary>
+			LineGeometry lineGeometry;
+			LineStream lineStream;
+			/// <summary>
+			/// The user transform of the current frame, that the line shader applies gain and rotation on top of
+			/// </summary>
+			LineTransform userView = LineTransform::identity();
+
+			/// <summary>
+			/// Draws the snapshot of a form, oldest first and receding in depth.
+			/// Gain and rotation are applied by the current matrix, and by the view for the line shader.
+			/// </summary>
+			void drawCoordinates(CoordinateStream::Form form, const LineTransform & view);
+
+			/// <summary>
+			/// Decaying density of the plotted samples for the accumulation mode, covering the plot space [-1, 1].
+			/// Rows are stored bottom up. Only touched by the rendering thread.
+			/// </summary>
+			struct Phosphor
+			{
+				cpl::aligned_vector<AFloat, 32> density;
+				PhosphorImage image;
+				/// <summary>
+				/// How many of the written coordinates have been splatted
+				/// </summary>
+				std::uint64_t consumed = 0;
+			} phosphor;
+
 			const SharedBehaviour & globalBehaviour;
 			VectorScopeContent * content;
 			AudioStream & audioStream;
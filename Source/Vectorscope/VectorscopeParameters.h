@@ -66,6 +66,9 @@
 					, ktransform(&parentValue.transform)
 					, kopMode(&parentValue.operationalMode.param)
 					, kenvelopeMode(&parentValue.autoGain.param)
+					, kaccumulate(&parentValue.accumulate)
+					, kaccumulationDecay(&parentValue.accumulationDecay)
+					, kmeterBands(&parentValue.meterBands.param)
 					, kpresets(&valueSerializer, "vectorscope")
 					, editorSerializer(
 						*this,
@@ -102,6 +105,7 @@
 					kmeterColour.bSetTitle("Meter colour");
 					kenvelopeSmooth.bSetTitle("Env. window");
 					kstereoSmooth.bSetTitle("Stereo window");
+					kaccumulationDecay.bSetTitle("Accum. decay");
 
 					// buttons n controls
 					kantiAlias.setSingleText("Antialias");
@@ -112,7 +116,10 @@
 					kdrawLines.setToggleable(true);
 					kdiagnostics.setSingleText("Diagnostics");
 					kdiagnostics.setToggleable(true);
+					kaccumulate.setSingleText("Accumulate");
+					kaccumulate.setToggleable(true);
 					kenvelopeMode.bSetTitle("Auto-gain mode");
+					kmeterBands.bSetTitle("Meter bands");
 
 					// design
 					kopMode.bSetTitle("Operational mode");
@@ -138,6 +145,9 @@
 					kenvelopeSmooth.bSetDescription("Responsiveness (RMS window size) - or the time it takes for the envelope follower to decay.");
 					kopMode.bSetDescription("Changes the presentation of the data - Lissajous is the classic XY mode on oscilloscopes, while the polar mode is a wrapped circle of the former.");
 					kstereoSmooth.bSetDescription("Responsiveness (RMS window size) - or the time it takes for the stereo meters to follow.");
+					kaccumulate.bSetDescription("Plots the samples as a density map instead of lines, where the places the signal visits most glow the brightest. Only samples that arrived since the last frame are added, so the window size has no effect on the rendering cost.");
+					kaccumulationDecay.bSetDescription("How long a sample stays visible in the density map - after this time, its brightness has dropped to 37%.");
+					kmeterBands.bSetDescription("Splits the stereo meters into logarithmically spaced crossover bands, drawn next to the broadband meters with the lowest band closest. Reveals mono compatibility problems in the low end, that wide highs would otherwise hide.");
 
 				}
 
@@ -158,6 +168,7 @@
 
 							section->addControl(&kopMode, 1);
 							section->addControl(&kstereoSmooth, 1);
+							section->addControl(&kmeterBands, 1);
 
 
 							section->addControl(&krotation, 0);
@@ -177,6 +188,7 @@
 							section->addControl(&kfadeOld, 1);
 							section->addControl(&kdrawLines, 2);
 							section->addControl(&kdiagnostics, 3);
+							section->addControl(&kaccumulate, 0);
 							page->addSection(section, "Options");
 						}
 						if (auto section = new Signalizer::CContentPage::MatrixSection())
@@ -187,6 +199,7 @@
 							section->addControl(&kskeletonColour, 0);
 							section->addControl(&kmeterColour, 1);
 							section->addControl(&kprimitiveSize, 1);
+							section->addControl(&kaccumulationDecay, 1);
 							page->addSection(section, "Look");
 						}
 					}
@@ -223,6 +236,9 @@
 					archive << kopMode;
 					archive << kstereoSmooth;
 					archive << kmeterColour;
+					archive << kaccumulate;
+					archive << kaccumulationDecay;
+					archive << kmeterBands;
 				}
 
 				void deserializeEditorSettings(cpl::CSerializer::Archiver & builder, cpl::Version version)
@@ -251,6 +267,13 @@
 					builder >> kopMode;
 					builder >> kstereoSmooth;
 					builder >> kmeterColour;
+
+					if (version >= cpl::Version(0, 3, 2))
+					{
+						builder >> kaccumulate;
+						builder >> kaccumulationDecay;
+						builder >> kmeterBands;
+					}
 				}
 
 				// entrypoints for completely storing values and settings in independant blobs (the preset widget)
@@ -286,11 +309,11 @@
 					}
 				}
 
-				cpl::CButton kantiAlias, kfadeOld, kdrawLines, kdiagnostics;
-				cpl::CValueKnobSlider kwindow, krotation, kgain, kprimitiveSize, kenvelopeSmooth, kstereoSmooth;
+				cpl::CButton kantiAlias, kfadeOld, kdrawLines, kdiagnostics, kaccumulate;
+				cpl::CValueKnobSlider kwindow, krotation, kgain, kprimitiveSize, kenvelopeSmooth, kstereoSmooth, kaccumulationDecay;
 				cpl::CColourControl kdrawingColour, kgraphColour, kbackgroundColour, kskeletonColour, kmeterColour;
 				cpl::CTransformWidget ktransform;
-				cpl::CValueComboBox kopMode, kenvelopeMode;
+				cpl::CValueComboBox kopMode, kenvelopeMode, kmeterBands;
 				cpl::CPresetWidget kpresets;
 
 				VectorScopeContent & parent;
@@ -306,6 +329,7 @@
 				, audioHistoryTransformatter(system.getAudioStream(), audioHistoryTransformatter.Milliseconds)
 
 				, dbRange(cpl::Math::dbToFraction(-120.0), cpl::Math::dbToFraction(120.0))
+				, accumulationRange(10, 10000)
 				, windowRange(0, 1000)
 				, degreeRange(0, 360)
 				, ptsRange(0.01, 10)
@@ -316,6 +340,7 @@
 
 				, autoGain("AutoGain")
 				, operationalMode("OpMode")
+				, meterBands("MeterBands")
 				, envelopeWindow("EnvWindow", windowRange, msFormatter)
 				, stereoWindow("StereoWindow", windowRange, msFormatter)
 				, inputGain("InputGain", dbRange, dbFormatter)
@@ -326,6 +351,8 @@
 				, interconnectSamples("Interconnect", boolRange, boolFormatter)
 				, diagnostics("Diagnostics", boolRange, boolFormatter)
 				, primitiveSize("PixelSize", ptsRange, ptsFormatter)
+				, accumulate("Accumulate", boolRange, boolFormatter)
+				, accumulationDecay("AccDecay", accumulationRange, msFormatter)
 
 
 				, colourBehaviour()
@@ -340,6 +367,7 @@
 			{
 				operationalMode.fmt.setValues({ "Lissajous", "Polar" });
 				autoGain.fmt.setValues({ "None", "RMS", "Peak decay" });
+				meterBands.fmt.setValues({ "Broadband", "3 bands", "4 bands", "5 bands", "6 bands", "7 bands", "8 bands", "9 bands", "10 bands" });
 
 				auto singleParameters = { 
 					&autoGain.param, &operationalMode.param, &envelopeWindow, &stereoWindow,
@@ -359,6 +387,11 @@
 				parameterSet.registerParameterBundle(&meterColour, meterColour.getBundleName());
 				parameterSet.registerParameterBundle(&transform, "3D.");
 
+				// registered last so earlier parameter indices stay stable
+				parameterSet.registerSingleParameter(accumulate.generateUpdateRegistrator());
+				parameterSet.registerSingleParameter(accumulationDecay.generateUpdateRegistrator());
+				parameterSet.registerSingleParameter(meterBands.param.generateUpdateRegistrator());
+
 				parameterSet.seal();
 
 				postParameterInitialization();
@@ -394,6 +427,9 @@
 				archive << operationalMode.param;
 				archive << stereoWindow;
 				archive << meterColour;
+				archive << accumulate;
+				archive << accumulationDecay;
+				archive << meterBands.param;
 			}
 
 			virtual void deserialize(cpl::CSerializer::Builder & builder, cpl::Version v) override
@@ -416,6 +452,13 @@
 				builder >> operationalMode.param;
 				builder >> stereoWindow;
 				builder >> meterColour;
+
+				if (v >= cpl::Version(0, 3, 2))
+				{
+					builder >> accumulate;
+					builder >> accumulationDecay;
+					builder >> meterBands.param;
+				}
 			}
 
 			AudioHistoryTransformatter<ParameterSet::ParameterView> audioHistoryTransformatter;
@@ -432,7 +475,7 @@
 
 			cpl::BooleanRange<double> boolRange;
 
-			cpl::ExponentialRange<double> dbRange;
+			cpl::ExponentialRange<double> dbRange, accumulationRange;
 
 			cpl::LinearRange<double>
 				ptsRange,
@@ -452,11 +495,14 @@
 				fadeOlderPoints,
 				interconnectSamples,
 				diagnostics,
-				primitiveSize;
+				primitiveSize,
+				accumulate,
+				accumulationDecay;
 
 			ChoiceParameter
 				autoGain,
-				operationalMode;
+				operationalMode,
+				meterBands;
 
 			cpl::ParameterColourValue<ParameterSet::ParameterView>::SharedBehaviour colourBehaviour;
 
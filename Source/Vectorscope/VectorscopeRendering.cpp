@@ -30,6 +30,7 @@
 
 #include "Vectorscope.h"
 #include <cstdint>
+#include <cstring>
 #include <cpl/CMutex.h>
 #include <cpl/Mathext.h>
 #include <cpl/rendering/OpenGLRasterizers.h>
@@ -128,11 +129,15 @@ namespace Signalizer
 			textures.push_back(std::unique_ptr<juce::OpenGLTexture>((new juce::OpenGLTexture())));
 			textures[i]->loadImage(letter);
 		}
+
+		lineStream.create();
 	}
 
 	void VectorScope::closeOpenGL()
 	{
 		textures.clear();
+		phosphor.image.release();
+		lineStream.release();
 	}
 
 	void VectorScope::onOpenGLRendering()
@@ -147,8 +152,12 @@ namespace Signalizer
 			CPL_DEBUGCHECKGL();
             {
                 auto cStart = cpl::Misc::ClockCounter();
-                auto && lockedView = audioStream.getAudioBufferViews();
-                handleFlagUpdates();
+                {
+                    // the stream is only locked while the flags are handled, the history is drawn from a snapshot
+                    auto && lockedView = audioStream.getAudioBufferViews();
+                    handleFlagUpdates();
+                }
+                updateSnapshot();
                 juce::OpenGLHelpers::clear(state.colourBackground);
                 {
                     cpl::OpenGLRendering::COpenGLStack openGLStack;
@@ -158,12 +167,20 @@ namespace Signalizer
                     cpl::GraphicsND::Transform3D<GLfloat> transform(1);
                     content->transform.fillTransform3D(transform);
                     openGLStack.applyTransform3D(transform);
+
+                    // the user transform is only known by the matrix it leaves behind, so the line shader starts from that
+                    if (lineStream.isCreated())
+                    {
+                        GLfloat modelView[16];
+                        glGetFloatv(GL_MODELVIEW_MATRIX, modelView);
+                        userView = LineTransform::fromColumnMajor(modelView);
+                    }
                     state.antialias ? openGLStack.enable(GL_MULTISAMPLE) : openGLStack.disable(GL_MULTISAMPLE);
 
-                    // the peak filter has to run on the whole buffer each time.
+                    // the peak filter decays every frame, towards the peaks tracked along with the history.
                     if (state.envelopeMode == EnvelopeModes::PeakDecay)
                     {
-                        runPeakFilter<ISA>(lockedView);
+                        runPeakFilter();
                     }
                     else if (state.envelopeMode == EnvelopeModes::None)
                     {
@@ -174,29 +191,40 @@ namespace Signalizer
                     openGLStack.setPointSize(static_cast<float>(oglc->getRenderingScale()) * state.primitiveSize);
 
                     // draw actual stereoscopic plot
-                    if (lockedView.getNumChannels() >= 2)
+                    if (snapshot.filled > 0)
                     {
-                        if (state.isPolar)
+                        if (state.accumulate)
                         {
-                            drawPolarPlot<ISA>(openGLStack, lockedView);
+                            accumulatePhosphor();
+                            drawPhosphor<ISA>(openGLStack);
+                        }
+                        else if (state.isPolar)
+                        {
+                            drawPolarPlot<ISA>(openGLStack);
                         }
                         else // is Lissajous
                         {
-                            drawRectPlot<ISA>(openGLStack, lockedView);
+                            drawRectPlot<ISA>(openGLStack);
                         }
                     }
                     CPL_DEBUGCHECKGL();
 
+                    if (!state.accumulate && phosphor.image.getWidth())
+                    {
+                        // start over from an empty image when turned on again
+                        phosphor.image.reset();
+                    }
+
                     openGLStack.setLineSize(static_cast<float>(oglc->getRenderingScale()) * 2.0f);
 
                     // draw graph and wireframe
                     drawWireFrame<ISA>(openGLStack);
                     CPL_DEBUGCHECKGL();
                     // draw channel text(ures)
-                    drawGraphText<ISA>(openGLStack, lockedView);
+                    drawGraphText<ISA>(openGLStack);
                     CPL_DEBUGCHECKGL();
                     // draw 2d stuff (like stereo meters)
-                    drawStereoMeters<ISA>(openGLStack, lockedView);
+                    drawStereoMeters<ISA>(openGLStack);
                     CPL_DEBUGCHECKGL();
                     renderCycles = cpl::Misc::ClockCounter() - cStart;
                 }
@@ -211,7 +239,7 @@ namespace Signalizer
 
 
 	template<typename ISA>
-		void VectorScope::drawGraphText(cpl::OpenGLRendering::COpenGLStack & openGLStack, const AudioStream::AudioBufferAccess & view)
+		void VectorScope::drawGraphText(cpl::OpenGLRendering::COpenGLStack & openGLStack)
 		{
 			openGLStack.enable(GL_TEXTURE_2D);
 			openGLStack.setBlender(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -401,7 +429,7 @@ namespace Signalizer
 
 
 	template<typename ISA>
-		void VectorScope::drawRectPlot(cpl::OpenGLRendering::COpenGLStack & openGLStack, const AudioStream::AudioBufferAccess & audio)
+		void VectorScope::drawRectPlot(cpl::OpenGLRendering::COpenGLStack & openGLStack)
 		{
 			cpl::OpenGLRendering::MatrixModification matrixMod;
 			// apply the custom rotation to the waveform
@@ -409,301 +437,252 @@ namespace Signalizer
 			// and apply the gain:
 			const auto gain = static_cast<GLfloat>(state.envelopeGain * state.userGain);
 			matrixMod.scale(gain, gain, 1);
-			float sampleFade = 1.0f / std::max<int>(1, static_cast<int>(audio.getNumSamples() - 1));
-
-			if (!state.fadeHistory)
-			{
-				cpl::OpenGLRendering::PrimitiveDrawer<1024> drawer(openGLStack, state.fillPath ? GL_LINE_STRIP : GL_POINTS);
-
-				drawer.addColour(state.colourDraw);
-
-				// TODO: glDrawArrays
-				audio.iterate<2, true>
-				(
-					[&] (std::size_t sampleFrame, const AudioStream::DataType & left, const AudioStream::DataType & right)
-					{
-						drawer.addVertex(right, left, sampleFrame * sampleFade - 1);
-					}
-				);
-
-			}
-			else
-			{
-				cpl::OpenGLRendering::PrimitiveDrawer<1024> drawer(openGLStack, state.fillPath ? GL_LINE_STRIP : GL_POINTS);
-
-				auto jcolour = state.colourDraw;
-				float red = jcolour.getFloatRed(), blue = jcolour.getFloatBlue(),
-				green = jcolour.getFloatGreen(), alpha = jcolour.getFloatGreen();
-
-				float fade = 0;
-
-				// TODO: glDrawArrays
-				audio.iterate<2, true>
-				(
-					[&] (std::size_t sampleFrame, AudioStream::DataType left, AudioStream::DataType right)
-					{
-						fade = sampleFrame * sampleFade;
-						drawer.addColour(fade * red, fade * green, fade * blue, alpha);
-						drawer.addVertex(right, left, fade - 1);
-					}
-				);
-
-			}
 
+			auto view = userView;
+			view.rotateZ(static_cast<float>(state.rotation * 360)).scale(gain, gain, 1);
 
+			drawCoordinates(CoordinateStream::Rect, view);
 		}
 
 
 	template<typename ISA>
-		void VectorScope::drawPolarPlot(cpl::OpenGLRendering::COpenGLStack & openGLStack, const AudioStream::AudioBufferAccess & audio)
+		void VectorScope::drawPolarPlot(cpl::OpenGLRendering::COpenGLStack & openGLStack)
 		{
-			typedef typename ISA::V V;
-			AudioStream::AudioBufferView views[2] = { audio.getView(0), audio.getView(1) };
-
-			using namespace cpl::simd;
-			using cpl::simd::abs;
-			typedef typename scalar_of<V>::type Ty;
-
 			cpl::OpenGLRendering::MatrixModification matrixMod;
 			const auto gain = static_cast<GLfloat>(state.envelopeGain * state.userGain);
-			auto const numSamples = views[0].size();
-			// TODO: handle all cases of potential signed overflow.
-			typedef std::make_signed<std::size_t>::type ssize_t;
-			ssize_t vectorLength = elements_of<V>::value;
 			matrixMod.scale(gain, gain, 1);
-			suitable_container<V> outX, outY, outFade;
-
-			// simd consts
-			const Ty cosineRotation = consts<Ty>::sqrt_half_two_minus;
-			const Ty sineRotation = consts<Ty>::sqrt_half_two;
-			const V vCosine = consts<V>::sqrt_half_two_minus; // equals e^i*0.75*pi
-			const V vSine = consts<V>::sqrt_half_two;
-			const V vZero = zero<V>();
-			const V vOne = consts<V>::one;
-			const V vSign = consts<V>::sign_bit;
-			auto const fadePerSample = (Ty)1.0 / numSamples;
-			auto const vIncrementalFade = set1<V>(fadePerSample * vectorLength);
-
-			const float
-				red = state.colourDraw.getFloatRed(),
-				green = state.colourDraw.getFloatGreen(),
-				blue = state.colourDraw.getFloatBlue();
-
-			for (int i = 0; i < vectorLength; ++i)
-			{
-				outFade[i] = fadePerSample * i;
-			}
-
-			V vSampleFade = outFade;
 
-			if(!state.fadeHistory)
-			{
-				cpl::OpenGLRendering::PrimitiveDrawer<1024> drawer(openGLStack, state.fillPath ? GL_LINE_STRIP : GL_POINTS);
-				drawer.addColour(red, green, blue);
-				// iterate front of buffer, then back.
+			auto view = userView;
+			view.scale(gain, gain, 1);
 
-				for (ssize_t section = 0; section < static_cast<ssize_t>(AudioStream::bufferIndices); ++section)
-				{
+			drawCoordinates(CoordinateStream::Polar, view);
+		}
 
-					// using signed ints to safely jump out of loops with elements_of<V> > sectionSamples
-					ssize_t i = 0;
+	void VectorScope::updateSnapshot()
+	{
+		auto & s = snapshot;
+		auto & c = coordinates;
 
-					const Ty * left = views[0].getItIndex(section);
-					const Ty * right = views[1].getItIndex(section);
+		const bool incremental = state.accumulate;
+		const std::size_t displayedForm = state.isPolar ? CoordinateStream::Polar : CoordinateStream::Rect;
 
-					ssize_t sectionSamples = views[0].getItRange(section);
+		// the history is transformed already, so only a copy is done while holding the lock
+		cpl::CMutex lock(c.lock);
 
-					for (; i < (sectionSamples - vectorLength); i += vectorLength)
-					{
-						V vLeft = loadu<V>(left + i);
-						V vRight = loadu<V>(right + i);
+		// incremental snapshots are always taken, but only hold what arrived since the last frame
+		if (c.version == s.version && !incremental && !s.incremental)
+			return;
 
-						// the length of the hypotenuse of the triangle, we
-						// convert the unit square to.
-						auto const vLength = max(abs(vLeft), abs(vRight));
+		s.version = c.version;
+		s.incremental = incremental;
+		s.written = c.written;
+		s.filled = c.filled;
+		s.count = c.filled;
+		s.peaks = c.peaks;
 
-						// rotate our view manually (to center on Y-axis)
-						V vY = vLeft * vCosine - vRight * vSine;
-						V vX = vLeft * vSine + vRight * vCosine;
+		if (incremental)
+		{
+			// the rings were resized, see accumulatePhosphor()
+			auto const consumed = c.written < phosphor.consumed ? 0 : phosphor.consumed;
+			s.count = static_cast<std::size_t>(std::min<std::uint64_t>(c.written - consumed, c.filled));
+		}
 
-						// check for any zero elements.
-						vLeft = (vLeft == vZero);
-						vRight = (vRight == vZero);
-						auto vMask = vnot(vand(vLeft, vRight));
+		if (!s.count)
+			return;
 
-						// get the phase angle. use atan2 if you want to draw the full circle.
-						// x and y are swapped at this point, btw.
-						auto vAngle = atan(vX / vY);
-						// replace nan elements of angle with zero
-						vAngle = vand(vMask, vAngle);
-						// calcuate x,y coordinates for the right triangle
-						sincos(vAngle, &vX, &vY);
+		// oldest first
+		const auto start = (c.cursor + c.frames - s.count) % c.frames;
+		const auto first = std::min(s.count, c.frames - start);
 
-						// construct triangle.
-						outX = vX * vLength;
-						outY = vY * vLength;
+		for (std::size_t form = 0; form < CoordinateStream::Forms; ++form)
+		{
+			if (incremental && form != displayedForm)
+				continue;
 
-						outFade = vSampleFade - vOne;
+			auto & pairs = s.pairs[form];
+			const auto * ring = c.rings[form].data();
 
-						// draw vertices.
-						for (cpl::ssize_t n = 0; n < vectorLength; ++n)
-						{
-							drawer.addVertex(outX[n], outY[n], outFade[n]);
-						}
+			if (pairs.size() < 2 * s.count)
+				pairs.resize(2 * s.count);
 
-						vSampleFade += vIncrementalFade;
+			std::memcpy(pairs.data(), ring + 2 * start, 2 * first * sizeof(GLfloat));
+			std::memcpy(pairs.data() + 2 * first, ring, 2 * (s.count - first) * sizeof(GLfloat));
+		}
+	}
 
-					}
-					//continue;
-					// deal with remainder, scalar route
-					ssize_t remaindingSamples = 0;
-					auto currentSampleFade = outFade[vectorLength - 1];
+	void VectorScope::drawCoordinates(CoordinateStream::Form form, const LineTransform & view)
+	{
+		const auto count = snapshot.count;
+		const auto & pairs = snapshot.pairs[form];
 
-					for (; i < sectionSamples; i++, remaindingSamples++)
-					{
-						Ty vLeft = left[i];
-						Ty vRight = right[i];
+		if (!count)
+			return;
 
-						// the length of the hypotenuse of the triangle, we
-						// convert the unit square to.
-						auto const length = std::max(std::abs(vLeft), std::abs(vRight));
+		// older samples recede into the screen, and fade out if set
+		const GLfloat sampleFade = 1.0f / std::max<GLfloat>(1, static_cast<GLfloat>(count - 1));
 
-						// rotate our view manually (to center on Y-axis)
-						Ty vY = vLeft * cosineRotation - vRight * sineRotation;
-						Ty vX = vLeft * sineRotation + vRight * cosineRotation;
+		// connected samples are widened and antialiased by the line shader, if it's available
+		if (state.fillPath && lineStream.isCreated())
+		{
+			const LineGeometry::Colour colour{ state.colourDraw.getRed(), state.colourDraw.getGreen(), state.colourDraw.getBlue(), state.colourDraw.getAlpha() };
+			const bool fade = state.fadeHistory;
+
+			lineGeometry.clear();
+			lineGeometry.addStrip(
+				count,
+				[&](std::size_t i) { return LineGeometry::Point{ pairs[2 * i], pairs[2 * i + 1], i * sampleFade - 1 }; },
+				[&](std::size_t i)
+				{
+					if (!fade)
+						return colour;
+
+					const auto amount = i * sampleFade;
+					return LineGeometry::Colour{
+						static_cast<std::uint8_t>(amount * colour.r),
+						static_cast<std::uint8_t>(amount * colour.g),
+						static_cast<std::uint8_t>(amount * colour.b),
+						0xFF
+					};
+				}
+			);
 
-						// check for any zero elements.
+			lineStream.draw(lineGeometry, view, static_cast<float>(oglc->getRenderingScale()) * state.primitiveSize, state.antialias);
+			return;
+		}
 
-						// get the phase angle. use atan2 if you want to draw the full circle.
-						// x and y are swapped at this point, btw.
-						auto angle = std::atan(vX / vY);
-						// replace nan elements of angle with zero
-						angle = (vLeft == Ty(0) && vRight == Ty(0)) ? Ty(0) : angle;
-						// calcuate x,y coordinates for the right triangle
-						sincos(angle, &vX, &vY);
+		auto & vertices = vertexBuffer.vertices;
+		auto & colours = vertexBuffer.colours;
 
-						drawer.addVertex(vX * length, vY * length, (currentSampleFade - remaindingSamples * fadePerSample));
+		if (vertices.size() < 3 * count)
+			vertices.resize(3 * count);
 
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			vertices[3 * i] = pairs[2 * i];
+			vertices[3 * i + 1] = pairs[2 * i + 1];
+			vertices[3 * i + 2] = i * sampleFade - 1;
+		}
 
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glVertexPointer(3, GL_FLOAT, 0, vertices.data());
 
-					}
-					// fractionally increase sample fade levels
-					vSampleFade += set1<V>(fadePerSample * remaindingSamples);
-				}
-			}
-			else // apply fading
-			{
+		if (state.fadeHistory)
+		{
+			if (colours.size() < 4 * count)
+				colours.resize(4 * count);
 
-				const V
-					vRed = set1<V>(red),
-					vGreen = set1<V>(green),
-					vBlue = set1<V>(blue);
+			const GLfloat red = state.colourDraw.getRed(), green = state.colourDraw.getGreen(), blue = state.colourDraw.getBlue();
 
-				suitable_container<V> outRed, outGreen, outBlue;
-				// iterate front of buffer, then back.
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const auto fade = i * sampleFade;
+				colours[4 * i] = static_cast<GLubyte>(fade * red);
+				colours[4 * i + 1] = static_cast<GLubyte>(fade * green);
+				colours[4 * i + 2] = static_cast<GLubyte>(fade * blue);
+				colours[4 * i + 3] = 0xFF;
+			}
 
-				cpl::OpenGLRendering::PrimitiveDrawer<1024> drawer(openGLStack, state.fillPath ? GL_LINE_STRIP : GL_POINTS);
+			glEnableClientState(GL_COLOR_ARRAY);
+			glColorPointer(4, GL_UNSIGNED_BYTE, 0, colours.data());
+		}
+		else
+		{
+			glColor4f(state.colourDraw.getFloatRed(), state.colourDraw.getFloatGreen(), state.colourDraw.getFloatBlue(), state.colourDraw.getFloatAlpha());
+		}
 
-				for (ssize_t section = 0; section < 2; ++section)
-				{
+		glDrawArrays(state.fillPath ? GL_LINE_STRIP : GL_POINTS, 0, static_cast<GLsizei>(count));
 
-					ssize_t i = 0;
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
+	}
 
-					const Ty * left = views[0].getItIndex(section);
-					const Ty * right = views[1].getItIndex(section);
+	void VectorScope::accumulatePhosphor()
+	{
+		auto & p = phosphor;
 
-					ssize_t sectionSamples = views[0].getItRange(section);
+		auto const scale = oglc->getRenderingScale();
+		auto const width = static_cast<std::size_t>(std::max(2.0, std::round(getWidth() * scale)));
+		auto const height = static_cast<std::size_t>(std::max(2.0, std::round(getHeight() * scale)));
 
-					for (; i < (sectionSamples - vectorLength); i += vectorLength)
-					{
-						V vLeft = loadu<V>(left + i);
-						V vRight = loadu<V>(right + i);
+		if (p.image.resize(width, height))
+			p.density.assign(width * height, 0);
 
-						// the length of the hypotenuse of the triangle, we
-						// convert the unit square to.
-						auto const vLength = max(abs(vLeft), abs(vRight));
+		const auto gain = static_cast<AFloat>(state.envelopeGain * state.userGain);
+		const auto angle = state.rotation * 2 * cpl::simd::consts<AFloat>::pi;
+		// the polar plot isn't rotated
+		const AFloat
+			rotationCosine = state.isPolar ? 1 : std::cos(angle),
+			rotationSine = state.isPolar ? 0 : std::sin(angle),
+			halfWidth = static_cast<AFloat>(width) * 0.5f,
+			halfHeight = static_cast<AFloat>(height) * 0.5f;
 
-						// rotate our view manually (to center on Y-axis)
-						V vY = vLeft * vCosine - vRight * vSine;
-						V vX = vLeft * vSine + vRight * vCosine;
+		auto * const density = p.density.data();
 
-						// check for any zero elements.
-						vLeft = (vLeft == vZero);
-						vRight = (vRight == vZero);
-						auto vMask = vnot(vand(vLeft, vRight));
+		// bilinear weights, so slowly moving traces don't snap to the pixel grid
+		auto splat = [&](AFloat x, AFloat y)
+		{
+			auto column = (gain * (x * rotationCosine - y * rotationSine) + 1) * halfWidth - 0.5f;
+			auto row = (gain * (x * rotationSine + y * rotationCosine) + 1) * halfHeight - 0.5f;
 
-						// get the phase angle. use atan2 if you want to draw the full circle.
-						// x and y are swapped at this point, btw.
-						auto vAngle = atan(vX / vY);
-						// replace nan elements of angle with zero
-						vAngle = vand(vMask, vAngle);
-						// calcuate x,y coordinates for the right triangle
-						sincos(vAngle, &vX, &vY);
+			// also rejects nans
+			if (!(column >= 0 && row >= 0 && column < width - 1 && row < height - 1))
+				return;
 
-						// construct triangle.
-						outX = vX * vLength;
-						outY = vY * vLength;
+			auto const c = static_cast<std::size_t>(column), r = static_cast<std::size_t>(row);
+			auto const fc = column - c, fr = row - r;
+			auto * const pixel = density + r * width + c;
 
-						outFade = vSampleFade - vOne;
+			pixel[0] += (1 - fc) * (1 - fr);
+			pixel[1] += fc * (1 - fr);
+			pixel[width] += (1 - fc) * fr;
+			pixel[width + 1] += fc * fr;
+		};
 
-						// set colours
+		// the rings were resized
+		if (snapshot.written < p.consumed)
+			p.consumed = 0;
 
-						outRed = vRed * vSampleFade;
-						outBlue = vBlue * vSampleFade;
-						outGreen = vGreen * vSampleFade;
+		// the newest coordinates are at the end of the snapshot
+		const auto count = static_cast<std::size_t>(std::min<std::uint64_t>(snapshot.written - p.consumed, snapshot.count));
+		p.consumed = snapshot.written;
 
-						// draw vertices.
-						for (cpl::ssize_t n = 0; n < vectorLength; ++n)
-						{
-							drawer.addColour(outRed[n], outGreen[n], outBlue[n]);
-							drawer.addVertex(outX[n], outY[n], outFade[n]);
-						}
+		const auto * pairs = snapshot.pairs[state.isPolar ? CoordinateStream::Polar : CoordinateStream::Rect].data() + 2 * (snapshot.count - count);
 
-						vSampleFade += vIncrementalFade;
+		for (std::size_t i = 0; i < count; ++i)
+			splat(pairs[2 * i], pairs[2 * i + 1]);
+	}
 
-					}
-					//continue;
-					// deal with remainder, scalar route
-					ssize_t remaindingSamples = 0;
-					auto currentSampleFade = outFade[vectorLength - 1];
+	template<typename ISA>
+		void VectorScope::drawPhosphor(cpl::OpenGLRendering::COpenGLStack & openGLStack)
+		{
+			auto & p = phosphor;
+			auto const width = p.image.getWidth(), height = p.image.getHeight();
 
-					for (; i < sectionSamples; i++, remaindingSamples++)
-					{
-						Ty vLeft = left[i];
-						Ty vRight = right[i];
+			if (!width || !height)
+				return;
 
-						// the length of the hypotenuse of the triangle, we
-						// convert the unit square to.
-						auto const length = std::max(std::abs(vLeft), std::abs(vRight));
+			auto const decay = static_cast<AFloat>(p.image.advance(state.accumulationDecay));
 
-						// rotate our view manually (to center on Y-axis)
-						Ty vY = vLeft * cosineRotation - vRight * sineRotation;
-						Ty vX = vLeft * sineRotation + vRight * cosineRotation;
+			// a trace spread over about a screen diagonal of pixels settles at one
+			const double sampleRate = audioStream.getInfo().sampleRate;
+			auto const exposure = (width + height) / std::max(1.0, sampleRate * state.accumulationDecay / 1000);
 
-						// check for any zero elements.
+			PhosphorImage::decay<ISA>(p.density.data(), width * height, decay);
 
-						// get the phase angle. use atan2 if you want to draw the full circle.
-						// x and y are swapped at this point, btw.
-						auto angle = std::atan(vX / vY);
-						// replace nan elements of angle with zero
-						angle = (vLeft == Ty(0) && vRight == Ty(0)) ? Ty(0) : angle;
-						// calcuate x,y coordinates for the right triangle
-						sincos(angle, &vX, &vY);
+			p.image.beginFrame();
+			p.image.shade<ISA>(p.density.data(), static_cast<AFloat>(exposure), state.colourDraw);
 
-						auto currentFade = (currentSampleFade - remaindingSamples * fadePerSample);
-						drawer.addColour(red * (currentFade + 1), green * (currentFade + 1), blue * (currentFade + 1));
-						drawer.addVertex(vX * length, vY * length, currentFade);
+			openGLStack.enable(GL_TEXTURE_2D);
+			openGLStack.setBlender(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
-					}
-					// fractionally increase sample fade levels
-					vSampleFade += set1<V>(fadePerSample * remaindingSamples);
+			p.image.draw(openGLStack);
 
-				}
-			}
+			openGLStack.disable(GL_TEXTURE_2D);
+			openGLStack.setBlender(GL_ONE, GL_ONE_MINUS_SRC_COLOR);
 		}
 
 	template<typename ISA>
-		void VectorScope::drawStereoMeters(cpl::OpenGLRendering::COpenGLStack & openGLStack, const AudioStream::AudioBufferAccess & audio)
+		void VectorScope::drawStereoMeters(cpl::OpenGLRendering::COpenGLStack & openGLStack)
 		{
 			using namespace cpl;
 			OpenGLRendering::MatrixModification m;
@@ -774,73 +753,98 @@ namespace Signalizer
 			// draw contrasting center piece for stereo
 			rect.setBounds(-balanceX, stereoY + stereoLength * 0.5f - indicatorSize * 0.125f, sideSize * heightToWidthFactor, indicatorSize * 0.125f);
 			rect.fill();
-		}
 
+			const auto bands = state.meterBands > 1 ? bandMeters.bands : 0;
 
-	template<typename ISA>
-		void VectorScope::runPeakFilter(const AudioStream::AudioBufferAccess & audio)
-		{
-			typedef typename ISA::V V;
+			if (bands < 2)
+				return;
 
-			double currentEnvelope = 1;
+			// the band meters are stacked inwards from the broadband meters, lowest band closest.
+			// correlation columns go to the left of the broadband one, and balance rows above the broadband one,
+			// shortened to end before the columns.
+			const float bandSize = sideSize * 0.5f;
+			const float bandPitch = bandSize * 1.25f;
+			const float columnsWidth = bands * bandPitch * heightToWidthFactor;
+			const float rowLength = balanceLength - columnsWidth;
 
-			if (audio.getNumChannels() >= 2)
+			float loudest = 0;
+
+			for (std::size_t i = 0; i < bands; ++i)
+				loudest = std::max(loudest, bandMeters.leftPower[i] + bandMeters.rightPower[i]);
+
+			for (std::size_t i = 0; i < bands; ++i)
 			{
-				AudioStream::AudioBufferView views[2] = { audio.getView(0), audio.getView(1) };
+				const float left = bandMeters.leftPower[i], right = bandMeters.rightPower[i];
 
-				std::size_t numSamples = views[0].size();
+				float balance = std::atan(right / left) / (simd::consts<float>::pi * 0.5f);
+				if (!std::isnormal(balance))
+					balance = 0.5f;
 
-				// since this runs in every frame, we need to scale the coefficient by how often this function runs
-				// (and the amount of samples)
-				double power = numSamples * (avgFps.getAverage() / juce::Time::getHighResolutionTicksPerSecond());
+				float correlation = bandMeters.crossPower[i] / std::sqrt(left * right);
+				if (!std::isfinite(correlation))
+					correlation = 0;
 
-				double coeff = std::pow(state.envelopeCoeff, power);
+				const float stereo = cpl::Math::confineTo(correlation, -1.0f, 1.0f) * 0.5f + 0.5f;
 
-				// there is a number of optimisations we can do here, mostly that we actually don't care about
-				// timing, we are only interested in the current largest value in the set.
-				using namespace cpl;
-				using namespace cpl::simd;
-				using cpl::simd::load;
+				// quieter bands are dimmed, over 60 dB below the loudest
+				float level = 1 + std::log10((left + right) / loudest) * (10.0f / 60);
+				if (!std::isfinite(level))
+					level = 0;
 
-				V
-					vLMax = zero<V>(),
-					vRMax = zero<V>(),
-					vSign = consts<V>::sign_mask;
+				const auto indicatorColour = state.colourMeter.withMultipliedBrightness(0.25f + 0.75f * cpl::Math::confineTo(level, 0.0f, 1.0f));
 
-				auto const loopIncrement = elements_of<V>::value;
+				const float columnX = -balanceX - (i + 1) * bandPitch * heightToWidthFactor;
+				const float rowY = balanceX + sideSize + i * bandPitch + (bandPitch - bandSize);
 
-				auto * leftBuffer = views[0].begin();
-				auto * rightBuffer = views[1].begin();
+				rect.setColour(indicatorColour);
+				rect.setBounds(balanceX + (rowLength - indicatorSize * 0.25f) * balance, rowY, indicatorSize * 0.25f, bandSize);
+				rect.fill();
+				rect.setBounds(columnX, stereoY + (stereoLength - indicatorSize * 0.25f) * stereo, bandSize * heightToWidthFactor, indicatorSize * 0.25f);
+				rect.fill();
 
-				auto stop = numSamples - (numSamples & (loopIncrement - 1));
-				if (stop <= 0)
-					stop = 0;
+				rect.setColour(state.colourMeter.withMultipliedBrightness(0.5f));
+				rect.setBounds(balanceX, rowY, rowLength, bandSize);
+				rect.renderOutline();
+				rect.setBounds(columnX, stereoY, bandSize * heightToWidthFactor, stereoLength);
+				rect.renderOutline();
 
-				for (std::size_t i = 0; i < stop; i += loopIncrement)
-				{
-					auto const vLInput = loadu<V>(leftBuffer + i);
-					vLMax = max(vand(vLInput, vSign), vLMax);
-					auto const vRInput = loadu<V>(rightBuffer + i);
-					vRMax = max(vand(vRInput, vSign), vRMax);
-				}
+				rect.setColour(pieceColour);
+				rect.setBounds(balanceX + rowLength * 0.5f - indicatorSize * 0.0625f, rowY, indicatorSize * 0.0625f, bandSize);
+				rect.fill();
+				rect.setBounds(columnX, stereoY + stereoLength * 0.5f - indicatorSize * 0.0625f, bandSize * heightToWidthFactor, indicatorSize * 0.0625f);
+				rect.fill();
+			}
+		}
 
-				// TODO: remainder?
 
-				suitable_container<V> lmax = vLMax, rmax = vRMax;
+	void VectorScope::runPeakFilter()
+	{
+		double currentEnvelope = 1;
 
-				double highestLeft = *std::max_element(lmax.begin(), lmax.end());
-				double highestRight = *std::max_element(rmax.begin(), rmax.end());
+		if (snapshot.filled > 0)
+		{
+			std::size_t numSamples = snapshot.filled;
 
-				filters.envelope[0] = std::max(filters.envelope[0] * coeff, highestLeft  * highestLeft);
-				filters.envelope[1] = std::max(filters.envelope[1] * coeff, highestRight * highestRight);
+			// since this runs in every frame, we need to scale the coefficient by how often this function runs
+			// (and the amount of samples)
+			double power = numSamples * (avgFps.getAverage() / juce::Time::getHighResolutionTicksPerSecond());
 
-				currentEnvelope = 1.0 / std::max(std::sqrt(filters.envelope[0]), std::sqrt(filters.envelope[1]));
+			double coeff = std::pow(state.envelopeCoeff, power);
 
-			}
+			// the peaks are tracked as the audio arrives, see appendCoordinates()
+			const double highestLeft = snapshot.peaks[0];
+			const double highestRight = snapshot.peaks[1];
 
-			if (std::isnormal(currentEnvelope))
-			{
-				state.envelopeGain = currentEnvelope;
-			}
+			filters.envelope[0] = std::max(filters.envelope[0] * coeff, highestLeft  * highestLeft);
+			filters.envelope[1] = std::max(filters.envelope[1] * coeff, highestRight * highestRight);
+
+			currentEnvelope = 1.0 / std::max(std::sqrt(filters.envelope[0]), std::sqrt(filters.envelope[1]));
+
+		}
+
+		if (std::isnormal(currentEnvelope))
+		{
+			state.envelopeGain = currentEnvelope;
 		}
+	}
 };